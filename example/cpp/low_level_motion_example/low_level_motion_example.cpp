@@ -1,3 +1,4 @@
+#include "magic_realtime.h"
 #include "magic_robot.h"
 #include "magic_sdk_version.h"
 
@@ -92,12 +93,17 @@ int main() {
 
   // Using arm joint control as an example:
   // Subsequent joint control commands, joint operation mode is 1, indicating the joint is in position control mode
-  auto now = std::chrono::steady_clock::now();
-  while (running.load()) {
+  // The fixed-capacity command is allocated once, so the control loop below does not touch the heap
+  ArmJointCommand arm_command;
+
+  // Send control command at 500Hz frequency (2ms) on a SCHED_FIFO thread, requires the rtprio limit from the README
+  RtControlLoopOptions loop_options;
+  loop_options.period_ns = 2000000;
+  loop_options.priority = 90;
+  RtControlLoop control_loop(loop_options);
+  status = control_loop.Start([&controller, &arm_command](const RtCycleInfo&) {
     // Left arm joints, refer to documentation:
     // Left arm or right arm joints 1-5 operation_mode needs to switch from mode: 200 to mode: 4 (series PID mode) for command execution;
-    JointCommand arm_command;
-    arm_command.joints.resize(kArmJointNum);
     for (int ii = 0; ii < kArmJointNum; ii++) {
       // Set joint to ready state
       arm_command.joints[ii].operation_mode = 200;
@@ -110,11 +116,24 @@ int main() {
     }
     // Publish control command
     controller.PublishArmCommand(arm_command);
+  });
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "start control loop failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+    robot.Shutdown();
+    return -1;
+  }
 
-    // Send control command at 500Hz frequency (2ms)
-    now += std::chrono::milliseconds(2);
-    std::this_thread::sleep_until(now);
+  while (running.load()) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto loop_stats = control_loop.GetStats();
+    std::cout << "control loop cycles: " << loop_stats.cycles
+              << ", overruns: " << loop_stats.overruns
+              << ", jitter p99 (ns): " << loop_stats.jitter.Percentile(99.0)
+              << ", jitter max (ns): " << loop_stats.jitter.max << std::endl;
   }
+  control_loop.Stop();
 
   // Disconnect from robot
   status = robot.Disconnect();
@@ -0,0 +1,84 @@
+#include "magic_latency_probe.h"
+#include "magic_motion_loopback.h"
+#include "magic_realtime.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace magic::gen1;
+using namespace magic::gen1::motion;
+
+std::atomic<bool> running(true);
+
+void signalHandler(int signum) {
+  std::cout << "Interrupt signal (" << signum << ") received.\n";
+
+  running = false;
+}
+
+int main(int argc, char* argv[]) {
+  // Bind SIGINT (Ctrl+C)
+  signal(SIGINT, signalHandler);
+
+  // Simulated latency of the loopback, in microseconds
+  LoopbackOptions loopback_options;
+  loopback_options.latency_ns = (argc > 1 ? std::atoll(argv[1]) : 500) * 1000;
+  LoopbackMotionController loopback(loopback_options);
+  if (!loopback.Initialize()) {
+    std::cerr << "loopback initialize failed." << std::endl;
+    return -1;
+  }
+
+  // Same publisher and state hub as on the robot, running on the loopback
+  LoopbackStateHub hub(loopback);
+  hub.Initialize();
+  LoopbackCommandPublisher publisher(loopback);
+
+  // Every published joint command is registered with the probe and correlated with the state that echoes it
+  auto probe = std::make_shared<RoundTripProbe>();
+  publisher.SetRoundTripProbe(probe);
+  hub.AddJointStateListener([probe](BodyPartMask part, const std::shared_ptr<JointState>& msg) {
+    probe->OnStateReceived(part, *msg);
+  });
+
+  // Publish leg commands at 500Hz (2ms), the command timestamp is the echo id
+  LegJointCommand leg_command;
+  RtControlLoopOptions loop_options;
+  loop_options.period_ns = 2000000;
+  loop_options.priority = 0;
+  loop_options.lock_memory = false;
+  RtControlLoop control_loop(loop_options);
+  auto status = control_loop.Start([&publisher, &leg_command](const RtCycleInfo& info) {
+    leg_command.timestamp = info.deadline_ns;
+    publisher.PublishLegCommand(leg_command);
+  });
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "start control loop failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+    return -1;
+  }
+
+  while (running.load()) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto stats = probe->GetStats();
+    std::cout << "sent: " << stats.sent
+              << ", matched: " << stats.matched
+              << ", lost: " << stats.lost
+              << ", round trip p50 (ns): " << stats.latency.Percentile(50.0)
+              << ", p99 (ns): " << stats.latency.Percentile(99.0)
+              << ", max (ns): " << stats.latency.max << std::endl;
+    if (stats.sent > 0 && !stats.echo_matched) {
+      std::cerr << "no command matched yet, the lost count reflects the matcher, not the link." << std::endl;
+    }
+  }
+  control_loop.Stop();
+  hub.Shutdown();
+  loopback.Shutdown();
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include "magic_robot.h"
+#include "magic_sdk_version.h"
+#include "magic_shm_transport.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+using namespace magic::gen1;
+using namespace magic::gen1::monitor;
+using namespace magic::gen1::transport;
+
+std::atomic<bool> running(true);
+std::atomic<bool> dump_requested(false);
+
+void signalHandler(int signum) {
+  std::cout << "Interrupt signal (" << signum << ") received.\n";
+
+  running = false;
+}
+
+void dumpHandler(int) { dump_requested = true; }
+
+int main() {
+  // Bind SIGINT (Ctrl+C) and SIGTERM (service stop)
+  signal(SIGINT, signalHandler);
+  signal(SIGTERM, signalHandler);
+  // SIGUSR1 dumps the blackbox on demand
+  signal(SIGUSR1, dumpHandler);
+
+  std::cout << "SDK Version: " << SDK_VERSION_STRING << std::endl;
+
+  MagicRobot robot;
+  std::string local_ip = "192.168.54.111";
+  // Configure local IP address for direct network connection and initialize SDK
+  if (!robot.Initialize(local_ip)) {
+    std::cerr << "robot sdk initialize failed." << std::endl;
+    robot.Shutdown();
+    return -1;
+  }
+
+  // Connect to robot, the only upstream connection on this host
+  auto status = robot.Connect();
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "connect robot failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+    robot.Shutdown();
+    return -1;
+  }
+
+  auto& controller = robot.GetLowLevelMotionController();
+
+  // One subscription per state topic, fanned out to the shared-memory rings
+  LowLevelStateHub hub(controller);
+  hub.Initialize();
+
+  // Client commands go through the publisher, a stalled link drops stale setpoints instead of replaying them
+  LowLevelCommandPublisher publisher(controller);
+  status = publisher.EnableConflation();
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "enable command conflation failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+  }
+
+  // Last 10 seconds of every command and state, dumped on demand, on new faults and on crashes
+  auto blackbox = std::make_shared<Blackbox>();
+  blackbox->Attach(hub);
+  blackbox->InstallCrashHandler();
+  publisher.SetBlackbox(blackbox);
+
+  ShmTransportServer server(hub, publisher);
+  status = server.Initialize();
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "start shared-memory transport failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+    robot.Shutdown();
+    return -1;
+  }
+  std::cout << "broker running, clients attach with ShmTransportClient." << std::endl;
+
+  auto& monitor = robot.GetStateMonitor();
+  int ticks = 0;
+  while (running.load()) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    RobotState state;
+    if (monitor.GetCurrentState(state).code == ErrorCode::OK && blackbox->OnRobotState(state)) {
+      std::cout << "new fault reported, blackbox dumped." << std::endl;
+    }
+    if (dump_requested.exchange(false)) {
+      std::cout << "blackbox dump " << (blackbox->Dump() ? "written." : "failed.") << std::endl;
+    }
+    if (++ticks % 5 != 0) {
+      continue;
+    }
+    for (const auto& client : server.GetClientStats()) {
+      std::cout << client.topic
+                << ", pid: " << client.reader.pid
+                << ", lag: " << client.reader.lag
+                << ", read: " << client.reader.read
+                << ", lost: " << client.reader.lost
+                << ", skipped: " << client.reader.skipped << std::endl;
+    }
+  }
+
+  server.Shutdown();
+  publisher.DisableConflation();
+  blackbox->Detach();
+  hub.Shutdown();
+
+  // Disconnect from robot
+  status = robot.Disconnect();
+  if (status.code != ErrorCode::OK) {
+    std::cerr << "disconnect robot failed"
+              << ", code: " << status.code
+              << ", message: " << status.message << std::endl;
+    robot.Shutdown();
+    return -1;
+  }
+
+  robot.Shutdown();
+
+  return 0;
+}
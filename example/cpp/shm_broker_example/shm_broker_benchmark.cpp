@@ -0,0 +1,169 @@
+#include "magic_motion_state.h"
+#include "magic_shm_transport.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace magic::gen1;
+using namespace magic::gen1::transport;
+
+namespace {
+
+// Rings as created by ShmTransportServer, written by synthetic publishers instead of the robot connection
+struct BrokerRings {
+  ShmRingPtr<ArmJointState> arm_state;
+  ShmRingPtr<LegJointState> leg_state;
+  ShmRingPtr<HeadJointState> head_state;
+  ShmRingPtr<WaistJointState> waist_state;
+  ShmRingPtr<FixedHandState> hand_state;
+  ShmRingPtr<Imu> body_imu;
+  ShmRingPtr<ArmJointCommand> arm_command;
+  ShmRingPtr<LegJointCommand> leg_command;
+  ShmRingPtr<HeadJointCommand> head_command;
+  ShmRingPtr<WaistJointCommand> waist_command;
+  ShmRingPtr<FixedHandCommand> hand_command;
+};
+
+template <typename T>
+void Publisher(ShmRing<T>& ring, int rate_hz, const std::atomic<bool>& running, std::atomic<uint64_t>& bytes) {
+  if (!ring.ClaimWriter()) {
+    std::cerr << "claim shared-memory ring failed." << std::endl;
+    return;
+  }
+  T record{};
+  auto period = std::chrono::nanoseconds(rate_hz > 0 ? 1000000000LL / rate_hz : 0);
+  auto next = std::chrono::steady_clock::now();
+  uint64_t count = 0;
+  while (running.load(std::memory_order_relaxed)) {
+    if (rate_hz > 0) {
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+    record.timestamp = motion::detail::SteadyNowNs();
+    ring.Write(record);
+    count++;
+  }
+  bytes.fetch_add(count * sizeof(T));
+}
+
+// One local client with every state subscription under the same backpressure policy
+void RunClient(const ShmTransportOptions& options, ShmBackpressure backpressure, int seconds) {
+  ShmTransportClient client(options);
+  if (!client.Initialize()) {
+    std::cerr << "client " << getpid() << " attach failed." << std::endl;
+    std::_Exit(1);
+  }
+  std::atomic<uint64_t> checksum{0};
+  auto consume = [&checksum](const auto& record) { checksum.fetch_add(static_cast<uint64_t>(record.timestamp), std::memory_order_relaxed); };
+  client.SubscribeArmState(consume, backpressure);
+  client.SubscribeLegState(consume, backpressure);
+  client.SubscribeHeadState(consume, backpressure);
+  client.SubscribeWaistState(consume, backpressure);
+  client.SubscribeHandState(consume, backpressure);
+  client.SubscribeBodyImu(consume, backpressure);
+  std::this_thread::sleep_for(std::chrono::seconds(seconds) + std::chrono::milliseconds(500));
+
+  uint64_t read = 0, lost = 0, skipped = 0;
+  for (const auto& stats : client.GetSubscriptionStats()) {
+    read += stats.read;
+    lost += stats.lost;
+    skipped += stats.skipped;
+  }
+  std::cout << "client " << getpid()
+            << (backpressure == ShmBackpressure::LATEST_ONLY ? " (LATEST_ONLY)" : " (DROP_OLDEST)")
+            << ", read: " << read
+            << ", lost: " << lost
+            << ", skipped: " << skipped
+            << ", read rate (msg/s): " << read / static_cast<uint64_t>(seconds) << std::endl;
+  client.Shutdown();
+  std::_Exit(0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int clients = argc > 1 ? std::atoi(argv[1]) : 3;
+  int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+  int rate_hz = argc > 3 ? std::atoi(argv[3]) : 0;
+  if (clients <= 0 || seconds <= 0 || rate_hz < 0) {
+    std::cerr << "usage: shm_broker_benchmark [clients] [seconds] [rate_hz]" << std::endl;
+    return -1;
+  }
+
+  ShmTransportOptions options;
+  options.prefix = "/magic_broker_bench." + std::to_string(getpid());
+  options.capacity = 256;
+  using Names = transport::detail::ShmTopicNames;
+  BrokerRings rings;
+  rings.arm_state = ShmRing<ArmJointState>::Create(Names::ArmState(options.prefix), options.capacity);
+  rings.leg_state = ShmRing<LegJointState>::Create(Names::LegState(options.prefix), options.capacity);
+  rings.head_state = ShmRing<HeadJointState>::Create(Names::HeadState(options.prefix), options.capacity);
+  rings.waist_state = ShmRing<WaistJointState>::Create(Names::WaistState(options.prefix), options.capacity);
+  rings.hand_state = ShmRing<FixedHandState>::Create(Names::HandState(options.prefix), options.capacity);
+  rings.body_imu = ShmRing<Imu>::Create(Names::BodyImu(options.prefix), options.capacity);
+  rings.arm_command = ShmRing<ArmJointCommand>::Create(Names::ArmCommand(options.prefix), options.capacity);
+  rings.leg_command = ShmRing<LegJointCommand>::Create(Names::LegCommand(options.prefix), options.capacity);
+  rings.head_command = ShmRing<HeadJointCommand>::Create(Names::HeadCommand(options.prefix), options.capacity);
+  rings.waist_command = ShmRing<WaistJointCommand>::Create(Names::WaistCommand(options.prefix), options.capacity);
+  rings.hand_command = ShmRing<FixedHandCommand>::Create(Names::HandCommand(options.prefix), options.capacity);
+  if (!rings.arm_state || !rings.leg_state || !rings.head_state || !rings.waist_state || !rings.hand_state || !rings.body_imu ||
+      !rings.arm_command || !rings.leg_command || !rings.head_command || !rings.waist_command || !rings.hand_command) {
+    std::cerr << "create shared-memory rings failed." << std::endl;
+    return -1;
+  }
+
+  // Alternate the backpressure policy across clients
+  std::vector<pid_t> children;
+  for (int ii = 0; ii < clients; ii++) {
+    pid_t child = fork();
+    if (child == 0) {
+      RunClient(options, ii % 2 == 0 ? ShmBackpressure::DROP_OLDEST : ShmBackpressure::LATEST_ONLY, seconds);
+    }
+    children.push_back(child);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+  std::cout << "6 synthetic publishers, " << clients << " clients, " << seconds << "s, rate per topic: "
+            << (rate_hz > 0 ? std::to_string(rate_hz) + "Hz" : std::string("unlimited")) << std::endl;
+  std::atomic<bool> publishing(true);
+  std::atomic<uint64_t> bytes(0);
+  std::vector<std::thread> publishers;
+  publishers.emplace_back([&] { Publisher(*rings.arm_state, rate_hz, publishing, bytes); });
+  publishers.emplace_back([&] { Publisher(*rings.leg_state, rate_hz, publishing, bytes); });
+  publishers.emplace_back([&] { Publisher(*rings.head_state, rate_hz, publishing, bytes); });
+  publishers.emplace_back([&] { Publisher(*rings.waist_state, rate_hz, publishing, bytes); });
+  publishers.emplace_back([&] { Publisher(*rings.hand_state, rate_hz, publishing, bytes); });
+  publishers.emplace_back([&] { Publisher(*rings.body_imu, rate_hz, publishing, bytes); });
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  publishing = false;
+  for (auto& publisher : publishers) {
+    publisher.join();
+  }
+
+  uint64_t written = rings.arm_state->Written() + rings.leg_state->Written() + rings.head_state->Written() +
+                     rings.waist_state->Written() + rings.hand_state->Written() + rings.body_imu->Written();
+  std::cout << "written: " << written
+            << ", write rate (msg/s): " << written / static_cast<uint64_t>(seconds)
+            << ", write bandwidth (MB/s): " << static_cast<double>(bytes.load()) / seconds / 1e6 << std::endl;
+  std::cout << "arm_state readers as seen by the broker:" << std::endl;
+  for (const auto& reader : rings.arm_state->GetReaderStats()) {
+    std::cout << "  pid: " << reader.pid
+              << ", lag: " << reader.lag
+              << ", read: " << reader.read
+              << ", lost: " << reader.lost
+              << ", skipped: " << reader.skipped << std::endl;
+  }
+
+  for (pid_t child : children) {
+    waitpid(child, nullptr, 0);
+  }
+  return 0;
+}
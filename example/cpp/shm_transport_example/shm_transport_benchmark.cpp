@@ -0,0 +1,150 @@
+#include "magic_histogram.h"
+#include "magic_motion_state.h"
+#include "magic_shm_ring.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace magic::gen1;
+using namespace magic::gen1::transport;
+
+namespace {
+
+// CPU time of the calling process (unit: nanoseconds)
+int64_t ProcessCpuNs() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000LL + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+void Report(const std::string& transport, const Histogram& latency, int64_t cpu_ns, int count) {
+  auto stats = latency.Snapshot();
+  std::cout << transport
+            << ": received " << stats.count << "/" << count
+            << ", latency p50 (ns): " << stats.Percentile(50.0)
+            << ", p99 (ns): " << stats.Percentile(99.0)
+            << ", max (ns): " << stats.max
+            << ", receiver cpu per message (ns): " << (stats.count > 0 ? cpu_ns / static_cast<int64_t>(stats.count) : 0) << std::endl;
+}
+
+// Publish arm joint states at a fixed rate, stamped with the monotonic send time
+template <typename Send>
+void PublishLoop(int count, int rate_hz, Send&& send) {
+  ArmJointState state;
+  auto period = std::chrono::nanoseconds(1000000000LL / rate_hz);
+  auto next = std::chrono::steady_clock::now();
+  for (int ii = 0; ii < count; ii++) {
+    next += period;
+    std::this_thread::sleep_until(next);
+    for (std::size_t jj = 0; jj < state.joints.size(); jj++) {
+      state.joints[jj].posH = ii * 0.001 + static_cast<double>(jj);
+    }
+    state.timestamp = motion::detail::SteadyNowNs();
+    send(state);
+  }
+}
+
+void BenchmarkShm(int count, int rate_hz) {
+  std::string name = "/magic_shm_bench." + std::to_string(getpid());
+  auto ring = ShmRing<ArmJointState>::Create(name, 64);
+  if (!ring || !ring->ClaimWriter()) {
+    std::cerr << "create shared-memory ring failed." << std::endl;
+    return;
+  }
+  pid_t child = fork();
+  if (child == 0) {
+    auto reader = ShmRing<ArmJointState>::Open(name);
+    if (!reader) {
+      std::cerr << "open shared-memory ring failed." << std::endl;
+      std::_Exit(1);
+    }
+    Histogram latency(0.0, 200000.0, 2000);
+    ShmCursor cursor = reader->MakeCursor();
+    ArmJointState state;
+    int64_t cpu_begin = ProcessCpuNs();
+    while (static_cast<int>(cursor.read + cursor.lost) < count && reader->Wait(cursor, 1000000000)) {
+      while (reader->Read(cursor, state)) {
+        latency.Record(static_cast<double>(motion::detail::SteadyNowNs() - state.timestamp));
+      }
+    }
+    Report("shared memory", latency, ProcessCpuNs() - cpu_begin, count);
+    std::_Exit(0);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  PublishLoop(count, rate_hz, [&ring](const ArmJointState& state) { ring->Write(state); });
+  waitpid(child, nullptr, 0);
+}
+
+void BenchmarkUdp(int count, int rate_hz) {
+  int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  if (receiver < 0 || bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+    std::cerr << "create udp socket failed." << std::endl;
+    return;
+  }
+  pid_t child = fork();
+  if (child == 0) {
+    Histogram latency(0.0, 200000.0, 2000);
+    timeval timeout{1, 0};
+    setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::vector<char> buffer(65536);
+    int64_t cpu_begin = ProcessCpuNs();
+    for (int ii = 0; ii < count; ii++) {
+      ssize_t size = recv(receiver, buffer.data(), buffer.size(), 0);
+      if (size < static_cast<ssize_t>(sizeof(int64_t))) {
+        break;
+      }
+      // Deserialize into the variable-size message handed to the Subscribe* callbacks
+      auto msg = std::make_shared<JointState>();
+      std::memcpy(&msg->timestamp, buffer.data(), sizeof(int64_t));
+      msg->joints.resize((static_cast<std::size_t>(size) - sizeof(int64_t)) / sizeof(SingleJointState));
+      std::memcpy(msg->joints.data(), buffer.data() + sizeof(int64_t), msg->joints.size() * sizeof(SingleJointState));
+      latency.Record(static_cast<double>(motion::detail::SteadyNowNs() - msg->timestamp));
+    }
+    Report("udp loopback", latency, ProcessCpuNs() - cpu_begin, count);
+    std::_Exit(0);
+  }
+  int sender = socket(AF_INET, SOCK_DGRAM, 0);
+  std::vector<char> buffer(sizeof(int64_t) + kArmJointNum * sizeof(SingleJointState));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  PublishLoop(count, rate_hz, [&](const ArmJointState& state) {
+    // Serialize as the network transport does before sending
+    std::memcpy(buffer.data(), &state.timestamp, sizeof(int64_t));
+    std::memcpy(buffer.data() + sizeof(int64_t), state.joints.data(), state.joints.size() * sizeof(SingleJointState));
+    sendto(sender, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  });
+  waitpid(child, nullptr, 0);
+  close(sender);
+  close(receiver);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 5000;
+  int rate_hz = argc > 2 ? std::atoi(argv[2]) : 1000;
+  if (count <= 0 || rate_hz <= 0) {
+    std::cerr << "usage: shm_transport_benchmark [messages] [rate_hz]" << std::endl;
+    return -1;
+  }
+  std::cout << "publishing " << count << " arm joint states at " << rate_hz << "Hz per transport" << std::endl;
+  BenchmarkShm(count, rate_hz);
+  BenchmarkUdp(count, rate_hz);
+  return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "magic_executor.h"
 #include "magic_export.h"
 #include "magic_type.h"
 
@@ -7,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace magic::gen1::audio {
 
@@ -99,6 +101,15 @@ class MAGIC_EXPORT_API AudioController final : public NonCopyable {
    */
   void SubscribeOriginAudioStream(const OriginAudioStreamCallback callback);
 
+  /**
+   * @brief Subscribe to original audio stream data with dispatch options
+   * @param callback Processing callback after receiving original audio stream data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeOriginAudioStream(OriginAudioStreamCallback callback, const SubscriptionOptions& options) {
+    SubscribeOriginAudioStream(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from original audio stream data
    */
@@ -110,6 +121,15 @@ class MAGIC_EXPORT_API AudioController final : public NonCopyable {
    */
   void SubscribeBfAudioStream(const BfAudioStreamCallback callback);
 
+  /**
+   * @brief Subscribe to BF audio stream data with dispatch options
+   * @param callback Processing callback after receiving BF audio stream data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeBfAudioStream(BfAudioStreamCallback callback, const SubscriptionOptions& options) {
+    SubscribeBfAudioStream(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from BF audio stream data
    */
@@ -133,6 +153,15 @@ class MAGIC_EXPORT_API AudioController final : public NonCopyable {
    */
   void SubscribeWakeupStatus(const WakeupStatusCallback callback);
 
+  /**
+   * @brief Subscribe to voice wake-up status with dispatch options
+   * @param callback Processing callback after receiving wake-up status
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWakeupStatus(WakeupStatusCallback callback, const SubscriptionOptions& options) {
+    SubscribeWakeupStatus(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from voice wake-up status
    */
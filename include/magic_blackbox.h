@@ -0,0 +1,578 @@
+#pragma once
+
+#include "magic_motion_state.h"
+#include "magic_type.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace magic::gen1::monitor {
+
+class Blackbox;
+using BlackboxPtr = std::shared_ptr<Blackbox>;
+
+/**
+ * @brief Stream a blackbox record belongs to, stored in every record of a dump
+ */
+enum class BlackboxStream : uint16_t {
+  ARM_COMMAND = 0,       ///< ArmJointCommand as published
+  LEG_COMMAND = 1,       ///< LegJointCommand as published
+  HEAD_COMMAND = 2,      ///< HeadJointCommand as published
+  WAIST_COMMAND = 3,     ///< WaistJointCommand as published
+  HAND_COMMAND = 4,      ///< FixedHandCommand as published
+  JOYSTICK_COMMAND = 5,  ///< JoystickCommand as sent
+  ARM_STATE = 6,         ///< ArmJointState as received
+  LEG_STATE = 7,         ///< LegJointState as received
+  HEAD_STATE = 8,        ///< HeadJointState as received
+  WAIST_STATE = 9,       ///< WaistJointState as received
+  HAND_STATE = 10,       ///< FixedHandState as received
+  BODY_IMU = 11,         ///< Imu as received
+  COUNT = 12,            ///< Number of streams
+};
+
+/**
+ * @brief What triggered a blackbox dump
+ */
+enum class BlackboxDumpReason : uint32_t {
+  ON_DEMAND = 0,  ///< Dump called by the application
+  FAULT = 1,      ///< New fault reported in RobotState
+  CRASH = 2,      ///< Fatal signal
+};
+
+/**
+ * @brief Blackbox configuration
+ */
+struct BlackboxOptions {
+  double seconds = 10.0;                  ///< History kept per stream (unit: seconds)
+  int joint_rate_hz = 1000;               ///< Expected joint, hand and IMU message rate, sizes those streams
+  int joystick_rate_hz = 50;              ///< Expected joystick command rate, sizes that stream
+  bool capture_time = true;               ///< Stamp records with the capture time, disable to skip the clock read per record
+  std::string directory = "/tmp";         ///< Directory of the dump files
+  std::string prefix = "magic_blackbox";  ///< Dump file name prefix, followed by the reason, process id and dump number
+};
+
+/**
+ * @brief Header at the start of a dump file
+ *
+ * It is followed by records, each a BlackboxRecordHeader and then record_size bytes of the raw stream type, in the
+ * memory layout of the machine that wrote the dump.
+ */
+struct BlackboxFileHeader {
+  char magic[8] = {'M', 'A', 'G', 'I', 'C', 'B', 'B', 'X'};  ///< File magic
+  uint32_t version = 1;                                        ///< Format version
+  uint32_t reason = 0;                                         ///< BlackboxDumpReason
+  int64_t dump_ns = 0;                                         ///< Monotonic time of the dump (unit: nanoseconds)
+  int64_t dump_realtime_ns = 0;                                ///< Wall-clock time of the dump (unit: nanoseconds)
+};
+
+/**
+ * @brief Header of one record in a dump file
+ */
+struct BlackboxRecordHeader {
+  uint16_t stream = 0;       ///< BlackboxStream
+  uint16_t reserved = 0;     ///< Zero
+  uint32_t record_size = 0;  ///< Size of the record that follows (unit: bytes)
+  uint64_t seq = 0;          ///< Sequence number within the stream, gaps are records overwritten or torn at dump time
+  int64_t capture_ns = 0;    ///< Monotonic capture time, 0 if capture_time is disabled (unit: nanoseconds)
+};
+
+namespace detail {
+
+/**
+ * @brief Preallocated ring of one blackbox stream, overwriting the oldest record.
+ */
+class BlackboxRing {
+ public:
+  BlackboxRing(BlackboxStream stream, std::size_t record_size, std::size_t capacity, bool capture_time)
+      : stream_(stream),
+        capture_time_(capture_time),
+        record_size_(record_size),
+        slot_size_((sizeof(Slot) + record_size + 63) / 64 * 64),
+        capacity_(std::max<std::size_t>(capacity, 1)),
+        storage_(std::make_unique<std::byte[]>(slot_size_ * capacity_)) {
+    for (std::size_t ii = 0; ii < capacity_; ii++) {
+      new (SlotAt(ii)) Slot();
+    }
+  }
+
+  // Begin a record in place, the payload must be written before EndWrite
+  void* BeginWrite(uint64_t& n) {
+    n = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot* slot = SlotAt(n % capacity_);
+    slot->seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (capture_time_) {
+      slot->capture_ns = motion::detail::SteadyNowNs();
+    }
+    return Payload(slot);
+  }
+
+  void EndWrite(uint64_t n) { SlotAt(n % capacity_)->seq.store(2 * n + 2, std::memory_order_release); }
+
+  /**
+   * @brief Copy every valid record, oldest first, into the output buffer and flush it when full.
+   * @note Async-signal-safe, only memcpy and the flush function are used.
+   */
+  template <typename Flush>
+  void Dump(std::byte* buffer, std::size_t buffer_size, std::size_t& used, Flush&& flush) const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t first = head > capacity_ ? head - capacity_ : 0;
+    std::size_t size = sizeof(BlackboxRecordHeader) + record_size_;
+    for (uint64_t n = first; n < head; n++) {
+      if (buffer_size - used < size) {
+        flush(buffer, used);
+        used = 0;
+      }
+      const Slot* slot = SlotAt(n % capacity_);
+      uint64_t expected = 2 * n + 2;
+      if (slot->seq.load(std::memory_order_acquire) != expected) {
+        continue;
+      }
+      BlackboxRecordHeader header;
+      header.stream = static_cast<uint16_t>(stream_);
+      header.record_size = static_cast<uint32_t>(record_size_);
+      header.seq = n;
+      header.capture_ns = slot->capture_ns;
+      std::memcpy(buffer + used, &header, sizeof(header));
+      std::memcpy(buffer + used + sizeof(header), Payload(slot), record_size_);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot->seq.load(std::memory_order_relaxed) == expected) {
+        used += size;
+      }
+    }
+  }
+
+  std::size_t MemorySize() const { return slot_size_ * capacity_; }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> seq{0};  // 2 * n + 1 while record n is written, 2 * n + 2 once it is complete
+    int64_t capture_ns = 0;
+  };
+
+  Slot* SlotAt(std::size_t index) const { return reinterpret_cast<Slot*>(storage_.get() + index * slot_size_); }
+  static void* Payload(const Slot* slot) { return reinterpret_cast<std::byte*>(const_cast<Slot*>(slot)) + sizeof(Slot); }
+
+  const BlackboxStream stream_;
+  const bool capture_time_;
+  const std::size_t record_size_;
+  const std::size_t slot_size_;
+  const std::size_t capacity_;
+  std::unique_ptr<std::byte[]> storage_;
+  std::atomic<uint64_t> head_{0};
+};
+
+/// Format an unsigned integer into a buffer without allocating, returns the end of the written digits
+inline char* FormatDecimal(char* out, uint64_t value) {
+  char digits[20];
+  int count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (count > 0) {
+    *out++ = digits[--count];
+  }
+  return out;
+}
+
+/// Blackbox dumped by the crash signal handler
+inline std::atomic<Blackbox*>& CrashBlackbox() {
+  static std::atomic<Blackbox*> instance{nullptr};
+  return instance;
+}
+
+/// Signals handled by the crash handler
+inline constexpr int kCrashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+/// Process-wide crash handler state, filled once by the first InstallCrashHandler
+struct CrashHandlerState {
+  std::atomic_bool installed{false};                         ///< Handlers installed
+  struct sigaction previous[std::size(kCrashSignals)] = {};  ///< Actions replaced by the crash handler, per signal
+  std::unique_ptr<std::byte[]> alt_stack;                    ///< Alternate signal stack of the installing thread
+};
+
+inline CrashHandlerState& CrashHandler() {
+  static CrashHandlerState state;
+  return state;
+}
+
+}  // namespace detail
+
+/**
+ * @class Blackbox
+ * @brief Always-on flight recorder of the last seconds of low-level commands and states.
+ *
+ * Every stream is a preallocated ring of fixed-size binary records sized from the configured history and rates, so
+ * capturing a message is one atomic increment, a clock read and a copy of the fixed-size record, and never allocates
+ * or locks. States are captured from a LowLevelStateHub (Attach), joint and hand commands from a
+ * LowLevelCommandPublisher (SetBlackbox) after its stages, i.e. as sent, and joystick commands with
+ * RecordJoystickCommand. The rings are written to a dump file on demand, when OnRobotState sees a new fault, or from
+ * the fatal signal handler installed with InstallCrashHandler.
+ */
+class Blackbox final : public NonCopyable {
+  using JointStatePtr = std::shared_ptr<JointState>;  // Joint state message pointer
+  using ImuPtr = std::shared_ptr<Imu>;                // IMU inertial measurement unit message pointer
+
+  static constexpr std::size_t kDumpBufferSize = 1 << 16;
+
+ public:
+  /**
+   * @brief Constructor, allocates all record storage.
+   * @param options History, expected rates and dump location.
+   */
+  explicit Blackbox(const BlackboxOptions& options = {}) : options_(options), dump_buffer_(std::make_unique<std::byte[]>(kDumpBufferSize)) {
+    auto joint_capacity = static_cast<std::size_t>(std::max(options.seconds, 0.0) * options.joint_rate_hz);
+    auto joystick_capacity = static_cast<std::size_t>(std::max(options.seconds, 0.0) * options.joystick_rate_hz);
+    AddRing<ArmJointCommand>(BlackboxStream::ARM_COMMAND, joint_capacity);
+    AddRing<LegJointCommand>(BlackboxStream::LEG_COMMAND, joint_capacity);
+    AddRing<HeadJointCommand>(BlackboxStream::HEAD_COMMAND, joint_capacity);
+    AddRing<WaistJointCommand>(BlackboxStream::WAIST_COMMAND, joint_capacity);
+    AddRing<FixedHandCommand>(BlackboxStream::HAND_COMMAND, joint_capacity);
+    AddRing<JoystickCommand>(BlackboxStream::JOYSTICK_COMMAND, joystick_capacity);
+    AddRing<ArmJointState>(BlackboxStream::ARM_STATE, joint_capacity);
+    AddRing<LegJointState>(BlackboxStream::LEG_STATE, joint_capacity);
+    AddRing<HeadJointState>(BlackboxStream::HEAD_STATE, joint_capacity);
+    AddRing<WaistJointState>(BlackboxStream::WAIST_STATE, joint_capacity);
+    AddRing<FixedHandState>(BlackboxStream::HAND_STATE, joint_capacity);
+    AddRing<Imu>(BlackboxStream::BODY_IMU, joint_capacity);
+  }
+
+  /// Destructor, detaches from the hub and uninstalls itself from the crash handler.
+  ~Blackbox() {
+    Detach();
+    Blackbox* self = this;
+    detail::CrashBlackbox().compare_exchange_strong(self, nullptr);
+  }
+
+  // === Capture Sources ===
+
+  /**
+   * @brief Capture every joint, hand and body IMU state received by the hub.
+   * @param hub Initialized state hub, must outlive the blackbox or be detached first.
+   */
+  void Attach(motion::LowLevelStateHub& hub) {
+    Detach();
+    hub_ = &hub;
+    listener_ids_.push_back(hub.AddJointStateListener([this](BodyPartMask part, const JointStatePtr& msg) { RecordState(part, *msg); }));
+    listener_ids_.push_back(hub.AddFixedHandStateListener([this](const FixedHandState& state) { Record(BlackboxStream::HAND_STATE, state); }));
+    listener_ids_.push_back(hub.AddBodyImuListener([this](const ImuPtr& msg) { Record(BlackboxStream::BODY_IMU, *msg); }));
+  }
+
+  /**
+   * @brief Stop capturing states from the hub.
+   */
+  void Detach() {
+    if (hub_ == nullptr) {
+      return;
+    }
+    for (uint64_t id : listener_ids_) {
+      hub_->RemoveListener(id);
+    }
+    listener_ids_.clear();
+    hub_ = nullptr;
+  }
+
+  /**
+   * @brief Capture a joint command of one body part.
+   * @param command Fixed-size joint command.
+   * @param timestamp Timestamp the command is sent with (unit: nanoseconds).
+   */
+  template <typename Limb>
+  void RecordCommand(const JointCommandT<Limb>& command, int64_t timestamp) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(CommandStream<Limb>())];
+    auto* record = static_cast<JointCommandT<Limb>*>(ring.BeginWrite(n));
+    std::memcpy(static_cast<void*>(record), static_cast<const void*>(&command), sizeof(command));
+    record->timestamp = timestamp;
+    ring.EndWrite(n);
+  }
+
+  /**
+   * @brief Capture a variable-size joint command of one body part, joints beyond the limb joint count are dropped.
+   * @param command Joint command.
+   */
+  template <typename Limb>
+  void RecordCommand(const JointCommand& command) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(CommandStream<Limb>())];
+    auto* record = static_cast<JointCommandT<Limb>*>(ring.BeginWrite(n));
+    record->timestamp = command.timestamp;
+    std::size_t count = std::min<std::size_t>(command.joints.size(), Limb::kJointNum);
+    std::copy_n(command.joints.begin(), count, record->joints.begin());
+    std::fill(record->joints.begin() + count, record->joints.end(), SingleJointCommand{});
+    ring.EndWrite(n);
+  }
+
+  /**
+   * @brief Capture a hand command.
+   * @param command Fixed-size hand command.
+   * @param timestamp Timestamp the command is sent with (unit: nanoseconds).
+   */
+  void RecordHandCommand(const FixedHandCommand& command, int64_t timestamp) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(BlackboxStream::HAND_COMMAND)];
+    auto* record = static_cast<FixedHandCommand*>(ring.BeginWrite(n));
+    *record = command;
+    record->timestamp = timestamp;
+    ring.EndWrite(n);
+  }
+
+  /**
+   * @brief Capture a variable-size hand command, degrees of freedom beyond the fixed size are dropped.
+   * @param command Hand command.
+   */
+  void RecordHandCommand(const HandCommand& command) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(BlackboxStream::HAND_COMMAND)];
+    auto* record = static_cast<FixedHandCommand*>(ring.BeginWrite(n));
+    *record = FixedHandCommand{};
+    record->timestamp = command.timestamp;
+    std::size_t hands = std::min<std::size_t>(command.cmd.size(), kHandNum);
+    for (std::size_t ii = 0; ii < hands; ii++) {
+      const auto& hand = command.cmd[ii];
+      record->hands[ii].operation_mode = hand.operation_mode;
+      std::copy_n(hand.pos.begin(), std::min<std::size_t>(hand.pos.size(), kHandJointNum), record->hands[ii].pos.begin());
+    }
+    ring.EndWrite(n);
+  }
+
+  /**
+   * @brief Capture a joystick command, call it next to HighLevelMotionController::SendJoyStickCommand.
+   * @param command Joystick command.
+   */
+  void RecordJoystickCommand(const JoystickCommand& command) { Record(BlackboxStream::JOYSTICK_COMMAND, command); }
+
+  // === Dumps ===
+
+  /**
+   * @brief Dump when the robot state reports a fault code that was not reported by the previous call.
+   * @param state Robot state, e.g. polled from StateMonitor::GetCurrentState.
+   * @return Whether a dump was written.
+   */
+  bool OnRobotState(const RobotState& state) {
+    bool new_fault = false;
+    std::vector<int> codes;
+    codes.reserve(state.faults.size());
+    for (const auto& fault : state.faults) {
+      codes.push_back(fault.error_code);
+      new_fault = new_fault || std::find(fault_codes_.begin(), fault_codes_.end(), fault.error_code) == fault_codes_.end();
+    }
+    fault_codes_ = std::move(codes);
+    return new_fault && Dump(BlackboxDumpReason::FAULT);
+  }
+
+  /**
+   * @brief Write the recorded history to a new file in the dump directory.
+   * @param reason Reason stored in the file header and name.
+   * @return Whether the file was written, false if another dump is in progress or the file cannot be written.
+   * @note Async-signal-safe, capture continues while the dump runs.
+   */
+  bool Dump(BlackboxDumpReason reason = BlackboxDumpReason::ON_DEMAND) {
+    if (dumping_.exchange(true, std::memory_order_acquire)) {
+      return false;
+    }
+    bool ok = WriteDump(reason);
+    dumping_.store(false, std::memory_order_release);
+    return ok;
+  }
+
+  /**
+   * @brief Dump this blackbox when the process receives SIGSEGV, SIGBUS, SIGFPE, SIGILL or SIGABRT.
+   *
+   * After the dump the action that was installed before is restored and the signal is raised again, so a previous
+   * handler still runs, or else the default action (e.g. a core dump) still happens. The handler runs on an alternate
+   * signal stack allocated here for the calling thread, if it has none, so a stack overflow on that thread is dumped
+   * too; other threads use their own alternate stack if they set one. Only one blackbox per process is dumped on a
+   * crash, the last one installed.
+   */
+  void InstallCrashHandler() {
+    detail::CrashBlackbox().store(this);
+    detail::CrashHandlerState& state = detail::CrashHandler();
+    if (state.installed.exchange(true)) {
+      return;
+    }
+    stack_t current{};
+    if (sigaltstack(nullptr, &current) == 0 && (current.ss_flags & SS_DISABLE) != 0) {
+      std::size_t size = std::max<std::size_t>(SIGSTKSZ, 1 << 16);
+      state.alt_stack = std::make_unique<std::byte[]>(size);
+      stack_t stack{};
+      stack.ss_sp = state.alt_stack.get();
+      stack.ss_size = size;
+      sigaltstack(&stack, nullptr);
+    }
+    struct sigaction action{};
+    action.sa_handler = &Blackbox::OnCrashSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_ONSTACK;
+    for (std::size_t ii = 0; ii < std::size(detail::kCrashSignals); ii++) {
+      sigaction(detail::kCrashSignals[ii], &action, &state.previous[ii]);
+    }
+  }
+
+  /**
+   * @brief Get the total preallocated record storage (unit: bytes).
+   */
+  std::size_t GetMemorySize() const {
+    std::size_t size = 0;
+    for (const auto& ring : rings_) {
+      size += ring->MemorySize();
+    }
+    return size;
+  }
+
+ private:
+  template <typename T>
+  void AddRing(BlackboxStream stream, std::size_t capacity) {
+    static_assert(std::is_trivially_copyable_v<T>, "blackbox records must be trivially copyable");
+    rings_[static_cast<std::size_t>(stream)] = std::make_unique<detail::BlackboxRing>(stream, sizeof(T), capacity, options_.capture_time);
+  }
+
+  template <typename T>
+  void Record(BlackboxStream stream, const T& value) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(stream)];
+    std::memcpy(ring.BeginWrite(n), static_cast<const void*>(&value), sizeof(T));
+    ring.EndWrite(n);
+  }
+
+  template <typename Limb>
+  static constexpr BlackboxStream CommandStream() {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return BlackboxStream::ARM_COMMAND;
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return BlackboxStream::LEG_COMMAND;
+    } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+      return BlackboxStream::HEAD_COMMAND;
+    } else {
+      static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb");
+      return BlackboxStream::WAIST_COMMAND;
+    }
+  }
+
+  void RecordState(BodyPartMask part, const JointState& msg) {
+    switch (part) {
+      case kBodyPartArm:
+        RecordJointState<ArmLimb>(BlackboxStream::ARM_STATE, msg);
+        break;
+      case kBodyPartLeg:
+        RecordJointState<LegLimb>(BlackboxStream::LEG_STATE, msg);
+        break;
+      case kBodyPartHead:
+        RecordJointState<HeadLimb>(BlackboxStream::HEAD_STATE, msg);
+        break;
+      case kBodyPartWaist:
+        RecordJointState<WaistLimb>(BlackboxStream::WAIST_STATE, msg);
+        break;
+      default:
+        break;
+    }
+  }
+
+  template <typename Limb>
+  void RecordJointState(BlackboxStream stream, const JointState& msg) {
+    uint64_t n = 0;
+    detail::BlackboxRing& ring = *rings_[static_cast<std::size_t>(stream)];
+    auto* record = static_cast<JointStateT<Limb>*>(ring.BeginWrite(n));
+    record->timestamp = msg.timestamp;
+    std::size_t count = std::min<std::size_t>(msg.joints.size(), Limb::kJointNum);
+    std::copy_n(msg.joints.begin(), count, record->joints.begin());
+    std::fill(record->joints.begin() + count, record->joints.end(), SingleJointState{});
+    ring.EndWrite(n);
+  }
+
+  // Only async-signal-safe calls: open, write, close, clock_gettime
+  bool WriteDump(BlackboxDumpReason reason) {
+    static const char* const kReasonNames[] = {"demand", "fault", "crash"};
+    char path[512];
+    std::size_t limit = sizeof(path) - 64;
+    std::size_t length = std::min(options_.directory.size(), limit / 2);
+    std::memcpy(path, options_.directory.data(), length);
+    path[length++] = '/';
+    std::size_t prefix = std::min(options_.prefix.size(), limit - length);
+    std::memcpy(path + length, options_.prefix.data(), prefix);
+    char* end = path + length + prefix;
+    *end++ = '_';
+    const char* name = kReasonNames[static_cast<uint32_t>(reason) % 3];
+    end = std::copy(name, name + std::strlen(name), end);
+    *end++ = '_';
+    end = detail::FormatDecimal(end, static_cast<uint64_t>(getpid()));
+    *end++ = '_';
+    end = detail::FormatDecimal(end, dump_count_.fetch_add(1, std::memory_order_relaxed));
+    end = std::copy_n(".bbx", 4, end);
+    *end = '\0';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    bool ok = true;
+    auto flush = [fd, &ok](const std::byte* data, std::size_t size) {
+      while (ok && size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written <= 0) {
+          ok = false;
+          return;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+      }
+    };
+
+    BlackboxFileHeader header;
+    header.reason = static_cast<uint32_t>(reason);
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    header.dump_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+    clock_gettime(CLOCK_REALTIME, &now);
+    header.dump_realtime_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+    flush(reinterpret_cast<const std::byte*>(&header), sizeof(header));
+
+    std::size_t used = 0;
+    for (const auto& ring : rings_) {
+      ring->Dump(dump_buffer_.get(), kDumpBufferSize, used, flush);
+    }
+    flush(dump_buffer_.get(), used);
+    close(fd);
+    return ok;
+  }
+
+  static void OnCrashSignal(int signum) {
+    if (Blackbox* blackbox = detail::CrashBlackbox().load()) {
+      blackbox->Dump(BlackboxDumpReason::CRASH);
+    }
+    // Restore the replaced action, the raised signal stays blocked until this handler returns and then reaches it
+    detail::CrashHandlerState& state = detail::CrashHandler();
+    for (std::size_t ii = 0; ii < std::size(detail::kCrashSignals); ii++) {
+      if (detail::kCrashSignals[ii] == signum) {
+        sigaction(signum, &state.previous[ii], nullptr);
+      }
+    }
+    raise(signum);
+  }
+
+  const BlackboxOptions options_;
+  std::unique_ptr<detail::BlackboxRing> rings_[static_cast<std::size_t>(BlackboxStream::COUNT)];
+  std::unique_ptr<std::byte[]> dump_buffer_;  // Preallocated, dumps never allocate
+  std::atomic_bool dumping_{false};
+  std::atomic<uint64_t> dump_count_{0};
+
+  motion::LowLevelStateHub* hub_ = nullptr;
+  std::vector<uint64_t> listener_ids_;
+  std::vector<int> fault_codes_;  // Fault codes of the previous OnRobotState call
+};
+
+}  // namespace magic::gen1::monitor
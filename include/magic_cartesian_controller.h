@@ -0,0 +1,263 @@
+#pragma once
+
+#include "magic_histogram.h"
+#include "magic_kinematics.h"
+#include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace magic::gen1::motion {
+
+class CartesianArmController;
+using CartesianArmControllerPtr = std::unique_ptr<CartesianArmController>;
+
+/**
+ * @brief Arm index of the Cartesian arm controller
+ */
+enum ArmSide : std::size_t {
+  kLeftArm = 0,   ///< Left arm, ArmLimb::kLeftJoint1-7
+  kRightArm = 1,  ///< Right arm, ArmLimb::kRightJoint1-7
+};
+
+/**
+ * @brief Cartesian arm controller configuration
+ */
+struct CartesianArmOptions {
+  kinematics::IkOptions ik;                    ///< Solver configuration, shared by both arms
+  int16_t operation_mode = 200;                ///< Operation mode of the published joints
+  std::array<double, kArmJointNum> kp{};       ///< Position gains of the published joints, in command order
+  std::array<double, kArmJointNum> kd{};       ///< Velocity gains of the published joints, in command order
+  int64_t max_state_age_ns = 20000000;         ///< Ticks are skipped while the latest arm state is older (unit: nanoseconds)
+  int64_t solve_histogram_range_ns = 2000000;  ///< Solve time histogram range (unit: nanoseconds)
+  std::size_t histogram_bins = 200;            ///< Number of histogram bins
+  RtControlLoopOptions loop;                   ///< Solve and publish loop, its period is the command rate (default 500Hz)
+};
+
+/**
+ * @brief Result of one controller tick
+ */
+struct CartesianArmTick {
+  uint64_t cycle = 0;                          ///< Loop cycle index
+  int64_t solve_ns = 0;                        ///< Time spent in inverse kinematics for both arms (unit: nanoseconds)
+  std::array<bool, 2> active{};                ///< Whether the arm had a target and was solved
+  std::array<kinematics::IkResult, 2> arms{};  ///< Solve result per arm, indexed by ArmSide
+  Status status{ErrorCode::OK, ""};            ///< Publish status
+};
+
+/**
+ * @brief Cartesian arm controller counters
+ */
+struct CartesianArmStats {
+  uint64_t ticks = 0;          ///< Ticks with at least one target that published a command
+  uint64_t not_converged = 0;  ///< Arm solves that hit the iteration cap before reaching the tolerances
+  uint64_t stale_state = 0;    ///< Ticks skipped because no recent arm state was available
+  uint64_t failed = 0;         ///< Publish calls that returned a status other than OK
+  HistogramSnapshot solve;     ///< Inverse kinematics time per tick (unit: nanoseconds)
+};
+
+/**
+ * @class CartesianArmController
+ * @brief Streams end-effector pose targets to the arms through damped least-squares inverse kinematics.
+ *
+ * Every loop period the controller solves each arm that has a target, warm-started from the latest measured arm joint
+ * state of the state hub, and publishes the joint solution with the configured gains. An arm without a target holds
+ * its last commanded positions, or the measured positions before its first target. The solver iteration cap keeps the
+ * solve time bounded; the per-tick callback and the solve histogram show the remaining error and the time spent.
+ * Commands are published through the command publisher. Targets reach the loop through a sequence lock and the
+ * counters are atomic, so setting targets or reading statistics never blocks the loop thread.
+ */
+class CartesianArmController final : public NonCopyable {
+  using TickCallback = std::function<void(const CartesianArmTick&)>;  // Per-tick result callback
+
+  // Targets of both arms, handed to the loop thread as one record
+  struct Targets {
+    std::array<kinematics::Transform, 2> poses;
+    std::array<bool, 2> active{};
+  };
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param publisher Command publisher used to publish the arm commands.
+   * @param hub Initialized state hub providing the latest arm joint state.
+   * @param left Left arm chain, tool frame at the end effector.
+   * @param right Right arm chain, tool frame at the end effector.
+   * @param options Controller configuration.
+   */
+  CartesianArmController(LowLevelCommandPublisher& publisher, const LowLevelStateHub& hub, const kinematics::ArmChain& left, const kinematics::ArmChain& right, const CartesianArmOptions& options = {})
+      : publisher_(publisher),
+        hub_(hub),
+        options_(options),
+        solvers_{kinematics::ArmInverseKinematics(left, options.ik), kinematics::ArmInverseKinematics(right, options.ik)},
+        solve_histogram_(0.0, static_cast<double>(options.solve_histogram_range_ns), options.histogram_bins),
+        loop_(options.loop) {}
+
+  /// Destructor, stops the control loop.
+  ~CartesianArmController() { Stop(); }
+
+  /**
+   * @brief Start the control loop.
+   * @return Execution status, fails if the histogram range is not positive or the real-time thread cannot be created.
+   */
+  Status Start() {
+    if (!solve_histogram_.IsValid()) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid solve histogram range"};
+    }
+    return loop_.Start([this](const RtCycleInfo& info) { Step(info); });
+  }
+
+  /**
+   * @brief Stop the control loop, targets are kept.
+   */
+  void Stop() { loop_.Stop(); }
+
+  /**
+   * @brief Set the end-effector target of one arm.
+   * @param side Arm.
+   * @param pose Tool frame pose in the chain reference frame.
+   */
+  void SetTarget(ArmSide side, const kinematics::Transform& pose) {
+    std::lock_guard<std::mutex> lock(target_mutex_);
+    pending_.poses[side] = pose;
+    pending_.active[side] = true;
+    targets_.BeginWrite() = pending_;
+    targets_.EndWrite();
+  }
+
+  /**
+   * @brief Drop the target of one arm, the arm holds its last commanded positions.
+   * @param side Arm.
+   */
+  void ClearTarget(ArmSide side) {
+    std::lock_guard<std::mutex> lock(target_mutex_);
+    pending_.active[side] = false;
+    targets_.BeginWrite() = pending_;
+    targets_.EndWrite();
+  }
+
+  /**
+   * @brief Set the per-tick result callback.
+   * @param callback Called on the loop thread after every published tick, must not block; nullptr to clear.
+   * @note Must be called before Start, the loop thread reads the callback without locking.
+   */
+  void SetTickCallback(TickCallback callback) { tick_callback_ = std::move(callback); }
+
+  /**
+   * @brief Get controller counters.
+   * @return Counters and solve time histogram accumulated since construction.
+   */
+  CartesianArmStats GetStats() const {
+    CartesianArmStats stats;
+    stats.ticks = ticks_.load(std::memory_order_relaxed);
+    stats.not_converged = not_converged_.load(std::memory_order_relaxed);
+    stats.stale_state = stale_state_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.solve = solve_histogram_.Snapshot();
+    return stats;
+  }
+
+  /**
+   * @brief Get the timing statistics of the control loop.
+   * @return Loop period, jitter and step time histograms.
+   */
+  RtControlLoopStats GetLoopStats() const { return loop_.GetStats(); }
+
+ private:
+  // One tick on the loop thread
+  void Step(const RtCycleInfo& info) {
+    // Keeps the previous targets if a SetTarget or ClearTarget overlaps the read, they are picked up next tick
+    targets_.TryRead(current_);
+    const std::array<bool, 2>& has_target = current_.active;
+    if (!has_target[kLeftArm] && !has_target[kRightArm]) {
+      return;
+    }
+    int64_t age = hub_.GetLatestArmState(state_);
+    if (age < 0 || age > options_.max_state_age_ns) {
+      stale_state_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!has_command_) {
+      for (std::size_t jj = 0; jj < kArmJointNum; jj++) {
+        command_.joints[jj] = {options_.operation_mode, state_.posL[jj], 0.0, 0.0, options_.kp[jj], options_.kd[jj]};
+      }
+      has_command_ = true;
+    }
+
+    CartesianArmTick tick;
+    tick.cycle = info.cycle;
+    double period_s = static_cast<double>(options_.loop.period_ns) * 1e-9;
+    int64_t begin = detail::SteadyNowNs();
+    for (std::size_t side = 0; side < 2; side++) {
+      auto& joints = solvers_[side].GetForwardKinematics().GetChain().joints;
+      if (!has_target[side]) {
+        for (const auto& joint : joints) {
+          command_.joints[joint.index].vel = 0.0;
+        }
+        continue;
+      }
+      kinematics::ArmInverseKinematics::Positions positions;
+      for (std::size_t ii = 0; ii < positions.size(); ii++) {
+        positions[ii] = state_.posL[joints[ii].index];
+      }
+      tick.arms[side] = solvers_[side].Solve(current_.poses[side], positions);
+      tick.active[side] = true;
+      for (std::size_t ii = 0; ii < positions.size(); ii++) {
+        SingleJointCommand& joint = command_.joints[joints[ii].index];
+        joint.vel = (positions[ii] - joint.pos) / period_s;
+        joint.pos = positions[ii];
+      }
+    }
+    tick.solve_ns = detail::SteadyNowNs() - begin;
+    solve_histogram_.Record(static_cast<double>(tick.solve_ns));
+
+    command_.timestamp = info.wakeup_ns;
+    tick.status = publisher_.PublishArmCommand(command_);
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+    for (std::size_t side = 0; side < 2; side++) {
+      if (tick.active[side] && !tick.arms[side].converged) {
+        not_converged_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    if (tick.status.code != ErrorCode::OK) {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (tick_callback_) {
+      tick_callback_(tick);
+    }
+  }
+
+  LowLevelCommandPublisher& publisher_;
+  const LowLevelStateHub& hub_;
+  const CartesianArmOptions options_;
+
+  std::mutex target_mutex_;  // Serializes SetTarget and ClearTarget, never taken by the loop thread
+  Targets pending_;          // Writer-side copy of the targets
+  detail::SeqLock<Targets> targets_;
+  std::atomic<uint64_t> ticks_{0};
+  std::atomic<uint64_t> not_converged_{0};
+  std::atomic<uint64_t> stale_state_{0};
+  std::atomic<uint64_t> failed_{0};
+
+  // Touched only by the loop thread
+  Targets current_;
+  std::array<kinematics::ArmInverseKinematics, 2> solvers_;
+  ArmJointStateSoA state_;
+  ArmJointCommand command_;
+  bool has_command_ = false;
+  TickCallback tick_callback_;
+  Histogram solve_histogram_;
+  RtControlLoop loop_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
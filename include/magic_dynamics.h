@@ -0,0 +1,260 @@
+#pragma once
+
+#include "magic_kinematics.h"
+#include "magic_type.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace magic::gen1::kinematics {
+
+template <typename Limb>
+class TorqueFeedforward;
+template <typename Limb>
+using TorqueFeedforwardPtr = std::shared_ptr<TorqueFeedforward<Limb>>;
+
+/**
+ * @class InverseDynamics
+ * @brief Recursive Newton-Euler inverse dynamics of a serial chain, with the chain length fixed at compile time.
+ *
+ * Joint torques are computed in the chain reference frame: a forward pass propagates link velocities and
+ * accelerations from the root (gravity enters as an upward acceleration of the root), a backward pass accumulates link
+ * forces and moments from the tip. The root is assumed fixed in the reference frame; set the gravity direction from
+ * the body IMU if the reference frame tilts.
+ *
+ * Not thread-safe; use one instance per thread.
+ *
+ * @tparam Limb Limb descriptor whose joint state drives the chain.
+ * @tparam N Number of joints in the chain.
+ */
+template <typename Limb, std::size_t N>
+class InverseDynamics final {
+ public:
+  using Chain = ChainDescriptor<Limb, N>;   ///< Chain descriptor
+  using Positions = std::array<double, N>;  ///< Joint values in chain order (positions, velocities, accelerations or torques)
+
+  /**
+   * @brief Constructor.
+   * @param chain Chain descriptor including the link mass properties.
+   * @param gravity Gravity acceleration in the reference frame (unit: m/s^2).
+   */
+  explicit InverseDynamics(const Chain& chain, const Vector3& gravity = {0.0, 0.0, -9.81}) : fk_(chain), gravity_(gravity) {}
+
+  /**
+   * @brief Set the gravity acceleration.
+   * @param gravity Gravity acceleration in the reference frame (unit: m/s^2).
+   */
+  void SetGravity(const Vector3& gravity) { gravity_ = gravity; }
+
+  /**
+   * @brief Move the chain root, e.g. to follow the waist.
+   * @param base Chain root in the reference frame.
+   */
+  void SetBase(const Transform& base) { fk_.SetBase(base); }
+
+  /**
+   * @brief Joint torques (forces for prismatic joints) for a given motion.
+   * @param positions Joint positions.
+   * @param velocities Joint velocities.
+   * @param accelerations Joint accelerations.
+   * @param[out] torques Joint torques (unit: Nm or N).
+   */
+  void Compute(const Positions& positions, const Positions& velocities, const Positions& accelerations, Positions& torques) {
+    fk_.Update(positions);
+
+    // Forward pass: angular velocity and acceleration of each link, linear acceleration of each link origin
+    std::array<Vector3, N> omega;
+    std::array<Vector3, N> alpha;
+    std::array<Vector3, N> accel;
+    Vector3 parent_omega{};
+    Vector3 parent_alpha{};
+    Vector3 parent_accel{-gravity_[0], -gravity_[1], -gravity_[2]};
+    Vector3 parent_origin = fk_.GetChain().base.translation;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      Vector3 axis = fk_.JointAxis(ii);
+      const Vector3& origin = fk_.LinkPose(ii).translation;
+      Vector3 offset = Sub(origin, parent_origin);
+      accel[ii] = Add(parent_accel, Add(Cross(parent_alpha, offset), Cross(parent_omega, Cross(parent_omega, offset))));
+      if (fk_.GetChain().joints[ii].type == JointType::REVOLUTE) {
+        omega[ii] = Add(parent_omega, Scale(axis, velocities[ii]));
+        alpha[ii] = Add(parent_alpha, Add(Scale(axis, accelerations[ii]), Scale(Cross(parent_omega, axis), velocities[ii])));
+      } else {
+        omega[ii] = parent_omega;
+        alpha[ii] = parent_alpha;
+        accel[ii] = Add(accel[ii], Add(Scale(axis, accelerations[ii]), Scale(Cross(parent_omega, axis), 2.0 * velocities[ii])));
+      }
+      parent_omega = omega[ii];
+      parent_alpha = alpha[ii];
+      parent_accel = accel[ii];
+      parent_origin = origin;
+    }
+
+    // Backward pass: force and moment transmitted through each joint, about the joint origin
+    Vector3 child_force{};
+    Vector3 child_moment{};
+    Vector3 child_origin{};
+    for (std::size_t ii = N; ii-- > 0;) {
+      const Transform& pose = fk_.LinkPose(ii);
+      const LinkInertia& link = fk_.GetChain().joints[ii].link;
+      Vector3 com = pose.Rotate(link.com);
+      Vector3 com_accel = Add(accel[ii], Add(Cross(alpha[ii], com), Cross(omega[ii], Cross(omega[ii], com))));
+      Vector3 force = Scale(com_accel, link.mass);
+      Transform inertia;  // Rotational inertia in the reference frame, R I R^T, applied through Rotate
+      inertia.rotation = Transform::Multiply(Transform::Multiply(pose.rotation, link.inertia), pose.Inverse().rotation);
+      Vector3 moment = Add(inertia.Rotate(alpha[ii]), Cross(omega[ii], inertia.Rotate(omega[ii])));
+
+      Vector3 total_force = Add(force, child_force);
+      Vector3 total_moment = Add(Add(moment, child_moment), Cross(com, force));
+      if (ii + 1 < N) {
+        total_moment = Add(total_moment, Cross(Sub(child_origin, pose.translation), child_force));
+      }
+      Vector3 axis = fk_.JointAxis(ii);
+      torques[ii] = fk_.GetChain().joints[ii].type == JointType::REVOLUTE ? Dot(axis, total_moment) : Dot(axis, total_force);
+      child_force = total_force;
+      child_moment = total_moment;
+      child_origin = pose.translation;
+    }
+  }
+
+  /**
+   * @brief Gravity torques, the torques holding the chain still.
+   * @param positions Joint positions.
+   * @param[out] torques Joint torques (unit: Nm or N).
+   */
+  void Gravity(const Positions& positions, Positions& torques) { Compute(positions, Positions{}, Positions{}, torques); }
+
+  /**
+   * @brief Gravity, Coriolis and centrifugal torques at zero joint acceleration.
+   * @param positions Joint positions.
+   * @param velocities Joint velocities.
+   * @param[out] torques Joint torques (unit: Nm or N).
+   */
+  void GravityAndCoriolis(const Positions& positions, const Positions& velocities, Positions& torques) { Compute(positions, velocities, Positions{}, torques); }
+
+ private:
+  static Vector3 Add(const Vector3& a, const Vector3& b) { return {a[0] + b[0], a[1] + b[1], a[2] + b[2]}; }
+  static Vector3 Sub(const Vector3& a, const Vector3& b) { return {a[0] - b[0], a[1] - b[1], a[2] - b[2]}; }
+  static Vector3 Scale(const Vector3& a, double s) { return {a[0] * s, a[1] * s, a[2] * s}; }
+  static double Dot(const Vector3& a, const Vector3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+  static Vector3 Cross(const Vector3& a, const Vector3& b) { return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]}; }
+
+  ForwardKinematics<Limb, N> fk_;
+  Vector3 gravity_;
+};
+
+using ArmInverseDynamics = InverseDynamics<ArmLimb, ArmLimb::kJointsPerSide>;  ///< One arm
+using LegInverseDynamics = InverseDynamics<LegLimb, LegLimb::kJointsPerSide>;  ///< One leg
+using HeadInverseDynamics = InverseDynamics<HeadLimb, HeadLimb::kJointNum>;    ///< Head
+
+/**
+ * @brief Number of joints of one kinematic chain of a body part
+ */
+template <typename Limb>
+struct LimbChainLength;
+template <>
+struct LimbChainLength<ArmLimb> {
+  static constexpr std::size_t value = ArmLimb::kJointsPerSide;  ///< One arm
+};
+template <>
+struct LimbChainLength<LegLimb> {
+  static constexpr std::size_t value = LegLimb::kJointsPerSide;  ///< One leg
+};
+template <>
+struct LimbChainLength<HeadLimb> {
+  static constexpr std::size_t value = HeadLimb::kJointNum;  ///< Head
+};
+
+/**
+ * @brief Torque feedforward terms
+ */
+enum class TorqueFeedforwardMode : int8_t {
+  GRAVITY = 0,           ///< Gravity torques at the commanded positions
+  GRAVITY_CORIOLIS = 1,  ///< Gravity, Coriolis and centrifugal torques at the commanded positions and velocities
+};
+
+/**
+ * @class TorqueFeedforward
+ * @brief Adds model-based torque feedforward to the joint commands of one body part.
+ *
+ * The body part is split into its chains (two arms, two legs or the head). For every chain the inverse dynamics are
+ * evaluated at the commanded positions and velocities, and the result is added to the toq field of the command, on top
+ * of any feedforward the application already set. Attach it to LowLevelCommandPublisher::SetFeedforward to fill the
+ * torques automatically before publishing.
+ *
+ * Apply is meant for one publishing thread.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb or HeadLimb).
+ */
+template <typename Limb>
+class TorqueFeedforward final : public NonCopyable {
+ public:
+  static constexpr std::size_t kChainLength = LimbChainLength<Limb>::value;  ///< Joints per chain
+  static constexpr std::size_t kChainNum = Limb::kJointNum / kChainLength;   ///< Chains of the body part
+  using Chain = ChainDescriptor<Limb, kChainLength>;                         ///< Chain descriptor
+  using Chains = std::array<Chain, kChainNum>;                               ///< Chains, e.g. left and right arm
+  static_assert(kChainNum * kChainLength == Limb::kJointNum, "chains must cover the body part");
+
+  /**
+   * @brief Constructor.
+   * @param chains Chains of the body part including the link mass properties.
+   * @param mode Feedforward terms.
+   * @param gravity Gravity acceleration in the reference frame (unit: m/s^2).
+   */
+  explicit TorqueFeedforward(const Chains& chains, TorqueFeedforwardMode mode = TorqueFeedforwardMode::GRAVITY, const Vector3& gravity = {0.0, 0.0, -9.81})
+      : dynamics_(MakeDynamics(chains, gravity, std::make_index_sequence<kChainNum>{})), mode_(mode) {
+    for (std::size_t cc = 0; cc < kChainNum; cc++) {
+      for (std::size_t ii = 0; ii < kChainLength; ii++) {
+        indices_[cc][ii] = chains[cc].joints[ii].index;
+      }
+    }
+  }
+
+  /**
+   * @brief Set the gravity acceleration, e.g. from the body IMU.
+   * @param gravity Gravity acceleration in the reference frame (unit: m/s^2).
+   * @note Not synchronized with Apply, call from the publishing thread.
+   */
+  void SetGravity(const Vector3& gravity) {
+    for (auto& dynamics : dynamics_) {
+      dynamics.SetGravity(gravity);
+    }
+  }
+
+  /**
+   * @brief Add the feedforward torques to a command in place.
+   * @param[in,out] command Joint control command.
+   */
+  void Apply(JointCommandT<Limb>& command) {
+    for (std::size_t cc = 0; cc < kChainNum; cc++) {
+      const auto& joints = indices_[cc];
+      typename InverseDynamics<Limb, kChainLength>::Positions positions;
+      typename InverseDynamics<Limb, kChainLength>::Positions velocities{};
+      typename InverseDynamics<Limb, kChainLength>::Positions torques;
+      for (std::size_t ii = 0; ii < kChainLength; ii++) {
+        positions[ii] = command.joints[joints[ii]].pos;
+        if (mode_ == TorqueFeedforwardMode::GRAVITY_CORIOLIS) {
+          velocities[ii] = command.joints[joints[ii]].vel;
+        }
+      }
+      dynamics_[cc].GravityAndCoriolis(positions, velocities, torques);
+      for (std::size_t ii = 0; ii < kChainLength; ii++) {
+        command.joints[joints[ii]].toq += torques[ii];
+      }
+    }
+  }
+
+ private:
+  template <std::size_t... I>
+  static std::array<InverseDynamics<Limb, kChainLength>, kChainNum> MakeDynamics(const Chains& chains, const Vector3& gravity, std::index_sequence<I...>) {
+    return {InverseDynamics<Limb, kChainLength>(chains[I], gravity)...};
+  }
+
+  std::array<InverseDynamics<Limb, kChainLength>, kChainNum> dynamics_;
+  const TorqueFeedforwardMode mode_;
+  std::array<std::array<std::size_t, kChainLength>, kChainNum> indices_{};  // Command index of every chain joint
+};
+
+}  // namespace magic::gen1::kinematics
\ No newline at end of file
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1 {
+
+class CallbackExecutor;
+using CallbackExecutorPtr = std::shared_ptr<CallbackExecutor>;
+
+/**
+ * @brief Thread on which a subscription callback runs
+ */
+enum class DispatchPolicy : int8_t {
+  INLINE = 0,            ///< On the SDK receive thread (default, lowest latency)
+  DEDICATED_THREAD = 1,  ///< On a thread owned by this subscription
+  SHARED_POOL = 2,       ///< On the threads of a CallbackExecutor shared by several subscriptions
+};
+
+/**
+ * @brief Callback executor configuration
+ */
+struct CallbackExecutorOptions {
+  std::size_t threads = 1;              ///< Number of worker threads
+  int priority = 0;                     ///< SCHED_FIFO priority [1, 99] of the workers, 0 keeps the default scheduler
+  int cpu = -1;                         ///< CPU core the workers are pinned to, -1 means no pinning
+  std::size_t queue_depth = 64;         ///< Pending callbacks, the oldest one is dropped when full
+  std::string name = "magic_executor";  ///< Worker thread name, truncated to 15 characters
+};
+
+/**
+ * @brief Subscription dispatch options
+ */
+struct SubscriptionOptions {
+  DispatchPolicy policy = DispatchPolicy::INLINE;  ///< Thread on which the callback runs
+  int priority = 0;                                ///< DEDICATED_THREAD: SCHED_FIFO priority [1, 99], 0 keeps the default scheduler
+  int cpu = -1;                                    ///< DEDICATED_THREAD: CPU core the thread is pinned to, -1 means no pinning
+  std::size_t queue_depth = 4;                     ///< DEDICATED_THREAD: pending messages, the oldest one is dropped when full
+  CallbackExecutorPtr executor;                    ///< SHARED_POOL: executor shared with other subscriptions
+};
+
+/**
+ * @class CallbackExecutor
+ * @brief Worker threads running subscription callbacks off the SDK receive threads.
+ *
+ * The queue is preallocated and bounded. When it is full the oldest pending callback is dropped, since only the
+ * freshest sensor or state message is useful. Posting never blocks the receive thread for longer than a queue insert.
+ */
+class CallbackExecutor final : public NonCopyable {
+  // Type-erased callback invocation, target and message are kept alive by the task
+  using Invoker = void (*)(const void* target, const std::shared_ptr<const void>& msg);
+
+  struct Task {
+    Invoker invoke = nullptr;
+    std::shared_ptr<const void> target;
+    std::shared_ptr<const void> msg;
+  };
+
+  // Pending callbacks, shared with the workers so that a worker detached by a destructor running on it can still exit
+  struct Queue {
+    explicit Queue(std::size_t depth)
+        : tasks(depth) {}
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Task> tasks;  // Ring buffer of pending callbacks
+    std::size_t head = 0;
+    std::size_t size = 0;
+    bool running = false;
+    std::atomic<uint64_t> dropped{0};
+  };
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param options Executor configuration.
+   */
+  explicit CallbackExecutor(const CallbackExecutorOptions& options = {})
+      : options_(options), queue_(std::make_shared<Queue>(std::max<std::size_t>(options.queue_depth, 1))) {}
+
+  /// Destructor, stops the worker threads.
+  ~CallbackExecutor() { Shutdown(); }
+
+  /**
+   * @brief Start the worker threads.
+   * @return Whether initialization was successful, fails if the real-time attributes cannot be applied.
+   */
+  bool Initialize() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (!workers_.empty()) {
+      return true;
+    }
+    {
+      std::lock_guard<std::mutex> queue_lock(queue_->mutex);
+      queue_->running = true;
+    }
+    workers_.resize(std::max<std::size_t>(options_.threads, 1));
+    for (std::size_t ii = 0; ii < workers_.size(); ii++) {
+      auto* queue = new std::shared_ptr<Queue>(queue_);
+      if (detail::CreateThread(workers_[ii], &CallbackExecutor::ThreadEntry, queue, options_.priority, options_.cpu, options_.name) != 0) {
+        delete queue;
+        workers_.resize(ii);
+        StopWorkers();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Stop the worker threads, pending callbacks are discarded.
+   */
+  void Shutdown() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    StopWorkers();
+  }
+
+  /**
+   * @brief Queue a callback invocation.
+   * @param invoke Invocation trampoline.
+   * @param target Callback object.
+   * @param msg Message passed to the callback.
+   */
+  void Post(Invoker invoke, std::shared_ptr<const void> target, std::shared_ptr<const void> msg) {
+    Queue& queue = *queue_;
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.size == queue.tasks.size()) {
+        queue.head = (queue.head + 1) % queue.tasks.size();
+        queue.size--;
+        queue.dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+      Task& task = queue.tasks[(queue.head + queue.size) % queue.tasks.size()];
+      task.invoke = invoke;
+      task.target = std::move(target);
+      task.msg = std::move(msg);
+      queue.size++;
+    }
+    queue.cv.notify_one();
+  }
+
+  /**
+   * @brief Whether the worker threads are running, callbacks posted otherwise are never invoked.
+   */
+  bool IsRunning() const {
+    std::lock_guard<std::mutex> lock(queue_->mutex);
+    return queue_->running;
+  }
+
+  /**
+   * @brief Get the number of callbacks dropped because the queue was full.
+   */
+  uint64_t GetDroppedCount() const { return queue_->dropped.load(std::memory_order_relaxed); }
+
+ private:
+  static void* ThreadEntry(void* arg) {
+    std::unique_ptr<std::shared_ptr<Queue>> queue(static_cast<std::shared_ptr<Queue>*>(arg));
+    Run(**queue);
+    return nullptr;
+  }
+
+  // Only touches the queue, the executor may already be destroyed when a detached worker returns here
+  static void Run(Queue& queue) {
+    Task task;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.cv.wait(lock, [&queue] { return queue.size > 0 || !queue.running; });
+        if (!queue.running) {
+          return;
+        }
+        task = std::move(queue.tasks[queue.head]);
+        queue.head = (queue.head + 1) % queue.tasks.size();
+        queue.size--;
+      }
+      task.invoke(task.target.get(), task.msg);
+      task.target.reset();
+      task.msg.reset();
+    }
+  }
+
+  void StopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(queue_->mutex);
+      queue_->running = false;
+      for (auto& task : queue_->tasks) {
+        task = Task{};
+      }
+      queue_->head = 0;
+      queue_->size = 0;
+    }
+    queue_->cv.notify_all();
+    for (pthread_t worker : workers_) {
+      // The last reference may be released by a callback running on the worker itself, it exits through Run once the
+      // callback returns and holds its own reference to the queue
+      if (pthread_equal(worker, pthread_self())) {
+        pthread_detach(worker);
+      } else {
+        pthread_join(worker, nullptr);
+      }
+    }
+    workers_.clear();
+  }
+
+  const CallbackExecutorOptions options_;
+  std::mutex control_mutex_;  // Serializes Initialize and Shutdown
+  std::vector<pthread_t> workers_;
+  std::shared_ptr<Queue> queue_;
+};
+
+/**
+ * @brief Wrap a subscription callback so that it runs according to the dispatch options.
+ * @param callback Subscription callback.
+ * @param options Dispatch policy, thread priority and CPU affinity.
+ * @return Callback to pass to the controller's Subscribe* interface. A dedicated thread lives as long as the
+ *         returned callback, i.e. until the subscription is released.
+ * @note If the dedicated thread cannot get real-time attributes it falls back to the default scheduler, if it cannot
+ *       be created at all the callback runs INLINE. SHARED_POOL without an executor, or with one that is not
+ *       initialized, behaves like INLINE.
+ */
+template <typename Msg>
+std::function<void(const std::shared_ptr<Msg>)> MakeDispatchedCallback(std::function<void(const std::shared_ptr<Msg>)> callback, const SubscriptionOptions& options) {
+  using Callback = std::function<void(const std::shared_ptr<Msg>)>;
+  if (!callback || options.policy == DispatchPolicy::INLINE) {
+    return callback;
+  }
+  CallbackExecutorPtr executor = options.executor;
+  if (options.policy == DispatchPolicy::DEDICATED_THREAD) {
+    CallbackExecutorOptions executor_options;
+    executor_options.threads = 1;
+    executor_options.priority = options.priority;
+    executor_options.cpu = options.cpu;
+    executor_options.queue_depth = options.queue_depth;
+    executor_options.name = "magic_sub";
+    executor = std::make_shared<CallbackExecutor>(executor_options);
+    if (!executor->Initialize()) {
+      executor_options.priority = 0;
+      executor = std::make_shared<CallbackExecutor>(executor_options);
+      executor->Initialize();
+    }
+  }
+  // Messages posted to an executor without workers would be queued and never delivered
+  if (!executor || !executor->IsRunning()) {
+    return callback;
+  }
+  auto target = std::make_shared<const Callback>(std::move(callback));
+  return [executor, target](const std::shared_ptr<Msg> msg) {
+    executor->Post(
+        [](const void* callback_target, const std::shared_ptr<const void>& erased_msg) {
+          (*static_cast<const Callback*>(callback_target))(std::const_pointer_cast<Msg>(std::static_pointer_cast<const Msg>(erased_msg)));
+        },
+        target, msg);
+  };
+}
+
+}  // namespace magic::gen1
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace magic::gen1 {
+
+namespace detail {
+
+/**
+ * @brief Whether a histogram range is usable.
+ * @return False if a bound is not finite or upper is not greater than lower.
+ */
+inline bool IsValidHistogramRange(double lower, double upper) { return std::isfinite(lower) && std::isfinite(upper) && upper > lower; }
+
+}  // namespace detail
+
+/**
+ * @brief Point-in-time copy of a Histogram
+ */
+struct HistogramSnapshot {
+  double lower = 0.0;          ///< Lower bound of the first bin
+  double bin_width = 0.0;      ///< Width of every bin
+  std::vector<uint64_t> bins;  ///< Sample count per bin
+  uint64_t underflow = 0;      ///< Samples below the lower bound
+  uint64_t overflow = 0;       ///< Samples at or above the upper bound
+  uint64_t count = 0;          ///< Total number of samples
+  uint64_t invalid = 0;        ///< Non-finite samples, or all samples if the range is invalid; not in any other field
+  double min = 0.0;            ///< Smallest sample, 0 if empty
+  double max = 0.0;            ///< Largest sample, 0 if empty
+  double mean = 0.0;           ///< Mean of all samples, 0 if empty
+
+  /**
+   * @brief Estimate a percentile from the bin counts.
+   * @param percentile Percentile in [0, 100].
+   * @return Upper edge of the bin containing the percentile, clamped to the observed min and max.
+   */
+  double Percentile(double percentile) const {
+    if (count == 0) {
+      return 0.0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count)));
+    uint64_t seen = underflow;
+    if (seen >= rank) {
+      return min;
+    }
+    for (std::size_t ii = 0; ii < bins.size(); ii++) {
+      seen += bins[ii];
+      if (seen >= rank) {
+        return std::clamp(lower + bin_width * static_cast<double>(ii + 1), min, max);
+      }
+    }
+    return max;
+  }
+};
+
+/**
+ * @brief Running count, min, max, mean, variance and RMS of a sample stream, without storing the samples.
+ *
+ * Mean and variance use Welford's update, which stays accurate for long streams with a large mean. Non-finite samples
+ * are only counted, so a single NaN or infinity does not poison the statistics. Not thread-safe.
+ */
+struct RunningStats {
+  uint64_t count = 0;    ///< Number of samples
+  uint64_t invalid = 0;  ///< Non-finite samples, not included in any other field
+  double min = 0.0;      ///< Smallest sample, 0 if empty
+  double max = 0.0;      ///< Largest sample, 0 if empty
+  double mean = 0.0;     ///< Mean of all samples
+  double m2 = 0.0;       ///< Sum of squared deviations from the mean
+  double sum_sq = 0.0;   ///< Sum of squared samples
+
+  /**
+   * @brief Add one sample.
+   * @param value Sample value.
+   */
+  void Add(double value) {
+    if (!std::isfinite(value)) {
+      invalid++;
+      return;
+    }
+    count++;
+    if (count == 1) {
+      min = value;
+      max = value;
+    } else {
+      min = std::min(min, value);
+      max = std::max(max, value);
+    }
+    double delta = value - mean;
+    mean += delta / static_cast<double>(count);
+    m2 += delta * (value - mean);
+    sum_sq += value * value;
+  }
+
+  /// Population variance, 0 if empty
+  double Variance() const { return count > 0 ? m2 / static_cast<double>(count) : 0.0; }
+
+  /// Population standard deviation, 0 if empty
+  double StdDev() const { return std::sqrt(Variance()); }
+
+  /// Root mean square, 0 if empty
+  double Rms() const { return count > 0 ? std::sqrt(sum_sq / static_cast<double>(count)) : 0.0; }
+};
+
+/**
+ * @class Histogram
+ * @brief Fixed-bin histogram with running min, max and mean.
+ *
+ * Storage is allocated once at construction, Record never allocates. Non-finite samples are only counted as
+ * invalid, and so is every sample if the range is not valid (see IsValid). Intended for one recording thread, Snapshot
+ * and Reset may be called concurrently from any other thread.
+ */
+class Histogram {
+ public:
+  /**
+   * @brief Constructor.
+   * @param lower Lower bound of the first bin.
+   * @param upper Upper bound of the last bin.
+   * @param bin_count Number of equally sized bins between lower and upper.
+   */
+  Histogram(double lower, double upper, std::size_t bin_count)
+      : valid_(detail::IsValidHistogramRange(lower, upper)),
+        lower_(valid_ ? lower : 0.0),
+        bin_width_(valid_ ? (upper - lower) / static_cast<double>(std::max<std::size_t>(bin_count, 1)) : 0.0),
+        bin_count_(std::max<std::size_t>(bin_count, 1)),
+        bins_(std::make_unique<std::atomic<uint64_t>[]>(bin_count_)) {
+    Reset();
+  }
+
+  /**
+   * @brief Add one sample.
+   * @param value Sample value.
+   */
+  void Record(double value) {
+    if (!valid_ || !std::isfinite(value)) {
+      invalid_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (value < lower_) {
+      underflow_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      // Compared as a double first, converting an out-of-range value to an integer is undefined
+      double position = (value - lower_) / bin_width_;
+      if (position < static_cast<double>(bin_count_)) {
+        bins_[static_cast<std::size_t>(position)].fetch_add(1, std::memory_order_relaxed);
+      } else {
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    if (value < min_.load(std::memory_order_relaxed)) {
+      min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+    sum_.store(sum_.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Whether the range given to the constructor is finite and not empty.
+   */
+  bool IsValid() const { return valid_; }
+
+  /**
+   * @brief Copy the current content.
+   * @return Histogram snapshot.
+   */
+  HistogramSnapshot Snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.lower = lower_;
+    snapshot.bin_width = bin_width_;
+    snapshot.bins.resize(bin_count_);
+    for (std::size_t ii = 0; ii < bin_count_; ii++) {
+      snapshot.bins[ii] = bins_[ii].load(std::memory_order_relaxed);
+    }
+    snapshot.underflow = underflow_.load(std::memory_order_relaxed);
+    snapshot.overflow = overflow_.load(std::memory_order_relaxed);
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.invalid = invalid_.load(std::memory_order_relaxed);
+    if (snapshot.count > 0) {
+      snapshot.min = min_.load(std::memory_order_relaxed);
+      snapshot.max = max_.load(std::memory_order_relaxed);
+      snapshot.mean = sum_.load(std::memory_order_relaxed) / static_cast<double>(snapshot.count);
+    }
+    return snapshot;
+  }
+
+  /**
+   * @brief Clear all samples.
+   */
+  void Reset() {
+    for (std::size_t ii = 0; ii < bin_count_; ii++) {
+      bins_[ii].store(0, std::memory_order_relaxed);
+    }
+    underflow_.store(0, std::memory_order_relaxed);
+    overflow_.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    invalid_.store(0, std::memory_order_relaxed);
+    sum_.store(0.0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+    max_.store(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+  }
+
+ private:
+  const bool valid_;
+  const double lower_;
+  const double bin_width_;
+  const std::size_t bin_count_;
+  std::unique_ptr<std::atomic<uint64_t>[]> bins_;
+  std::atomic<uint64_t> underflow_{0};
+  std::atomic<uint64_t> overflow_{0};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> invalid_{0};
+  std::atomic<double> sum_{0.0};
+  std::atomic<double> min_{0.0};
+  std::atomic<double> max_{0.0};
+};
+
+}  // namespace magic::gen1
\ No newline at end of file
@@ -0,0 +1,263 @@
+#pragma once
+
+#include "magic_histogram.h"
+#include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace magic::gen1::motion {
+
+template <typename Limb>
+class ImpedanceController;
+template <typename Limb>
+using ImpedanceControllerPtr = std::unique_ptr<ImpedanceController<Limb>>;
+
+namespace detail {
+
+/**
+ * @brief Copy the latest structure-of-arrays joint state of any body part from the state hub.
+ * @return Age of the sample (unit: nanoseconds), negative if no sample was received yet.
+ */
+template <typename Limb>
+int64_t GetLatestLimbState(const LowLevelStateHub& hub, JointStateSoA<Limb>& state) {
+  if constexpr (std::is_same_v<Limb, ArmLimb>) {
+    return hub.GetLatestArmState(state);
+  } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+    return hub.GetLatestLegState(state);
+  } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+    return hub.GetLatestHeadState(state);
+  } else {
+    static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb");
+    return hub.GetLatestWaistState(state);
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Impedance controller configuration
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct ImpedanceControllerOptions {
+  using Array = std::array<double, Limb::kJointNum>;  ///< One value per joint
+
+  int16_t operation_mode = 200;                                     ///< Operation mode of the published torque commands
+  Array toq_max = Filled(std::numeric_limits<double>::infinity());  ///< Maximum absolute published torque per joint (unit: Nm)
+  int64_t max_state_age_ns = 10000000;                              ///< Cycles are skipped while the latest joint state is older (unit: nanoseconds)
+  int64_t state_histogram_range_ns = 10000000;                      ///< State age histogram range (unit: nanoseconds)
+  std::size_t histogram_bins = 200;                                 ///< Number of histogram bins
+  RtControlLoopOptions loop;                                        ///< Control loop, its period is the command rate (default 500Hz)
+
+  /// Array with every joint set to value
+  static constexpr Array Filled(double value) {
+    Array array{};
+    for (auto& element : array) {
+      element = value;
+    }
+    return array;
+  }
+};
+
+/**
+ * @brief Impedance controller counters
+ */
+struct ImpedanceControllerStats {
+  uint64_t published = 0;       ///< Torque commands published
+  uint64_t stale_state = 0;     ///< Cycles skipped because no recent joint state was available
+  uint64_t failed = 0;          ///< Publish calls that returned a status other than OK
+  uint64_t saturated = 0;       ///< Cycles with at least one torque clamped to toq_max
+  HistogramSnapshot state_age;  ///< Age of the joint state used by each published cycle (unit: nanoseconds)
+};
+
+/**
+ * @class ImpedanceController
+ * @brief Closes a joint impedance loop in the SDK at the full servo rate.
+ *
+ * The application sets impedance targets (position, velocity, stiffness kp, damping kd and feedforward torque) at
+ * whatever rate it manages. Every loop period the controller reads the freshest joint state from the state hub and
+ * publishes the torque
+ *
+ *     toq = kp * (pos - measured_pos) + kd * (vel - measured_vel) + feedforward_toq
+ *
+ * clamped to toq_max, with the command kp and kd set to zero. Positions are the low encoder readings. Nothing is
+ * published before the first target or while the joint state is older than max_state_age_ns. Commands are published
+ * through the command publisher; the target reaches the loop through a sequence lock and the counters are atomic, so
+ * SetTarget and GetStats never block the loop thread.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+class ImpedanceController final : public NonCopyable {
+  static constexpr std::size_t N = Limb::kJointNum;
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param publisher Command publisher used to publish the torque commands.
+   * @param hub Initialized state hub providing the latest joint state.
+   * @param options Controller configuration.
+   */
+  ImpedanceController(LowLevelCommandPublisher& publisher, const LowLevelStateHub& hub, const ImpedanceControllerOptions<Limb>& options = {})
+      : publisher_(publisher),
+        hub_(hub),
+        options_(options),
+        state_age_histogram_(0.0, static_cast<double>(options.state_histogram_range_ns), options.histogram_bins),
+        loop_(options.loop) {}
+
+  /// Destructor, stops the control loop.
+  ~ImpedanceController() { Stop(); }
+
+  /**
+   * @brief Start the control loop.
+   * @return Execution status, fails if the histogram range is not positive or the real-time thread cannot be created.
+   */
+  Status Start() {
+    if (!state_age_histogram_.IsValid()) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid state age histogram range"};
+    }
+    return loop_.Start([this](const RtCycleInfo& info) { Step(info.wakeup_ns); });
+  }
+
+  /**
+   * @brief Stop the control loop, the target is kept.
+   */
+  void Stop() { loop_.Stop(); }
+
+  /**
+   * @brief Set the impedance targets.
+   * @param target Per-joint pos, vel, kp, kd and feedforward toq; operation_mode and timestamp are ignored.
+   */
+  void SetTarget(const JointCommandT<Limb>& target) {
+    std::lock_guard<std::mutex> lock(target_mutex_);
+    Target& record = target_.BeginWrite();
+    for (std::size_t jj = 0; jj < N; jj++) {
+      const SingleJointCommand& joint = target.joints[jj];
+      record.pos[jj] = joint.pos;
+      record.vel[jj] = joint.vel;
+      record.kp[jj] = joint.kp;
+      record.kd[jj] = joint.kd;
+      record.toq[jj] = joint.toq;
+    }
+    record.active = true;
+    target_.EndWrite();
+  }
+
+  /**
+   * @brief Drop the target, publishing stops until the next SetTarget.
+   */
+  void ClearTarget() {
+    std::lock_guard<std::mutex> lock(target_mutex_);
+    target_.BeginWrite().active = false;
+    target_.EndWrite();
+  }
+
+  /**
+   * @brief Get controller counters.
+   * @return Counters and state age histogram accumulated since construction.
+   */
+  ImpedanceControllerStats GetStats() const {
+    ImpedanceControllerStats stats;
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.stale_state = stale_state_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.saturated = saturated_.load(std::memory_order_relaxed);
+    stats.state_age = state_age_histogram_.Snapshot();
+    return stats;
+  }
+
+  /**
+   * @brief Get the timing statistics of the control loop.
+   * @return Loop period, jitter and step time histograms.
+   */
+  RtControlLoopStats GetLoopStats() const { return loop_.GetStats(); }
+
+ private:
+  using Array = typename ImpedanceControllerOptions<Limb>::Array;
+
+  // Impedance targets, one array per field
+  struct Target {
+    alignas(64) Array pos{};
+    alignas(64) Array vel{};
+    alignas(64) Array kp{};
+    alignas(64) Array kd{};
+    alignas(64) Array toq{};
+    bool active = false;  // Cleared by ClearTarget
+  };
+
+  // One cycle on the loop thread
+  void Step(int64_t now) {
+    // Keeps the previous target if a SetTarget or ClearTarget overlaps the read, it is picked up next cycle
+    target_.TryRead(target_copy_);
+    if (!target_copy_.active) {
+      return;
+    }
+    int64_t age = detail::GetLatestLimbState(hub_, state_);
+    if (age < 0 || age > options_.max_state_age_ns) {
+      stale_state_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    // Branch-free over the structure-of-arrays state, vectorized in Release builds
+    alignas(64) Array toq;
+    bool saturated = false;
+    for (std::size_t jj = 0; jj < N; jj++) {
+      double raw = target_copy_.kp[jj] * (target_copy_.pos[jj] - state_.posL[jj]) + target_copy_.kd[jj] * (target_copy_.vel[jj] - state_.vel[jj]) + target_copy_.toq[jj];
+      double below = raw > options_.toq_max[jj] ? options_.toq_max[jj] : raw;
+      double limited = below < -options_.toq_max[jj] ? -options_.toq_max[jj] : below;
+      saturated |= limited != raw;
+      toq[jj] = limited;
+    }
+    for (std::size_t jj = 0; jj < N; jj++) {
+      command_.joints[jj] = {options_.operation_mode, target_copy_.pos[jj], target_copy_.vel[jj], toq[jj], 0.0, 0.0};
+    }
+    command_.timestamp = now;
+    Status status = publisher_.PublishJointCommand(command_);
+    state_age_histogram_.Record(static_cast<double>(age));
+
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if (saturated) {
+      saturated_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (status.code != ErrorCode::OK) {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  LowLevelCommandPublisher& publisher_;
+  const LowLevelStateHub& hub_;
+  const ImpedanceControllerOptions<Limb> options_;
+
+  std::mutex target_mutex_;  // Serializes SetTarget and ClearTarget, never taken by the loop thread
+  detail::SeqLock<Target> target_;
+  std::atomic<uint64_t> published_{0};
+  std::atomic<uint64_t> stale_state_{0};
+  std::atomic<uint64_t> failed_{0};
+  std::atomic<uint64_t> saturated_{0};
+
+  // Touched only by the loop thread
+  Target target_copy_;
+  JointStateSoA<Limb> state_;
+  JointCommandT<Limb> command_;
+  Histogram state_age_histogram_;
+  RtControlLoop loop_;
+};
+
+using ArmImpedanceController = ImpedanceController<ArmLimb>;      ///< Upper limbs impedance controller
+using LegImpedanceController = ImpedanceController<LegLimb>;      ///< Lower limbs impedance controller
+using HeadImpedanceController = ImpedanceController<HeadLimb>;    ///< Head impedance controller
+using WaistImpedanceController = ImpedanceController<WaistLimb>;  ///< Waist impedance controller
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
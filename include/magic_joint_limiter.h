@@ -0,0 +1,271 @@
+#pragma once
+
+#include "magic_type.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+template <typename Limb>
+class JointLimiter;
+template <typename Limb>
+using JointLimiterPtr = std::shared_ptr<JointLimiter<Limb>>;
+
+/**
+ * @brief Per-joint limit table of one body part
+ *
+ * All limits default to unlimited. Velocity and torque limits are symmetric around zero.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct JointLimitTable {
+  static constexpr std::size_t kJointNum = Limb::kJointNum;  ///< Number of joints
+  using Array = std::array<double, kJointNum>;               ///< One value per joint
+
+  Array pos_min = Filled(-std::numeric_limits<double>::infinity());  ///< Minimum target position (unit: rad or m)
+  Array pos_max = Filled(std::numeric_limits<double>::infinity());   ///< Maximum target position (unit: rad or m)
+  Array vel_max = Filled(std::numeric_limits<double>::infinity());   ///< Maximum absolute target velocity (unit: rad/s or m/s)
+  Array toq_max = Filled(std::numeric_limits<double>::infinity());   ///< Maximum absolute target torque (unit: Nm)
+  Array step_max = Filled(std::numeric_limits<double>::infinity());  ///< Maximum target position change per publish (unit: rad or m)
+
+  /// Array with every joint set to value
+  static constexpr Array Filled(double value) {
+    Array array{};
+    for (auto& element : array) {
+      element = value;
+    }
+    return array;
+  }
+};
+
+/**
+ * @brief How often each limit of one joint was applied
+ */
+struct JointLimitCounters {
+  uint64_t position = 0;  ///< Target position clamped to [pos_min, pos_max]
+  uint64_t velocity = 0;  ///< Target velocity clamped to +/- vel_max
+  uint64_t torque = 0;    ///< Target torque clamped to +/- toq_max
+  uint64_t step = 0;      ///< Target position change limited to step_max
+  uint64_t invalid = 0;   ///< Non-finite target position, velocity or torque replaced
+};
+
+/**
+ * @brief Limiter counters of one body part
+ */
+struct JointLimiterStats {
+  uint64_t commands = 0;                   ///< Commands passed through the limiter
+  uint64_t limited = 0;                    ///< Commands with at least one limited joint
+  std::vector<JointLimitCounters> joints;  ///< Counters per joint, in command order
+};
+
+/**
+ * @class JointLimiter
+ * @brief Clamps target position, velocity, torque and per-publish position step of every joint of one body part.
+ *
+ * The command is gathered into aligned per-field arrays and every limit is applied across all joints with
+ * branch-free min/max loops over a compile-time joint count, which the compiler vectorizes in Release builds (SSE2,
+ * AVX or NEON, no intrinsics). Position limits are applied after the step limit, so they always hold. The step limit
+ * is relative to the previous limited command. A non-finite (NaN or infinite) target position, velocity or torque is
+ * replaced by the previous limited value of that field before the limits are applied; before the first command these
+ * are zero velocity and torque and the position zero clamped to [pos_min, pos_max].
+ *
+ * Apply is meant for one publishing thread; GetStats may be called from any thread.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+class JointLimiter final : public NonCopyable {
+  static constexpr std::size_t N = Limb::kJointNum;
+  using Array = typename JointLimitTable<Limb>::Array;
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param table Limit table.
+   */
+  explicit JointLimiter(const JointLimitTable<Limb>& table = {}) { SetLimits(table); }
+
+  /**
+   * @brief Replace the limit table.
+   * @param table Limit table.
+   * @note Not synchronized with Apply, call while no command is being published.
+   */
+  void SetLimits(const JointLimitTable<Limb>& table) {
+    pos_min_ = table.pos_min;
+    pos_max_ = table.pos_max;
+    vel_max_ = table.vel_max;
+    toq_max_ = table.toq_max;
+    step_max_ = table.step_max;
+  }
+
+  /**
+   * @brief Forget the previous command, the next command is not step limited.
+   */
+  void ResetStep() {
+    has_last_ = false;
+    last_vel_.fill(0.0);
+    last_toq_.fill(0.0);
+  }
+
+  /**
+   * @brief Limit a command in place.
+   * @param[in,out] command Joint control command.
+   * @return Whether any limit was applied.
+   */
+  bool Apply(JointCommandT<Limb>& command) {
+    alignas(64) Array pos;
+    alignas(64) Array vel;
+    alignas(64) Array toq;
+    for (std::size_t jj = 0; jj < N; jj++) {
+      pos[jj] = command.joints[jj].pos;
+      vel[jj] = command.joints[jj].vel;
+      toq[jj] = command.joints[jj].toq;
+    }
+
+    // Flags are doubles (0 or 1) so the compare results stay in the same vector lanes as the data
+    alignas(64) Array hit_step;
+    alignas(64) Array hit_pos;
+    alignas(64) Array hit_vel;
+    alignas(64) Array hit_toq;
+    alignas(64) Array hit_invalid;
+    if (!has_last_) {
+      // No step limit on the first command, a non-finite position falls back to zero inside the position limits
+      for (std::size_t jj = 0; jj < N; jj++) {
+        double zero = 0.0 > pos_max_[jj] ? pos_max_[jj] : 0.0;
+        last_[jj] = std::isfinite(pos[jj]) ? pos[jj] : (zero < pos_min_[jj] ? pos_min_[jj] : zero);
+      }
+    }
+    // Non-finite targets would pass through the compare-based clamps and disable the step limit through last_
+    for (std::size_t jj = 0; jj < N; jj++) {
+      bool pos_ok = std::isfinite(pos[jj]);
+      bool vel_ok = std::isfinite(vel[jj]);
+      bool toq_ok = std::isfinite(toq[jj]);
+      pos[jj] = pos_ok ? pos[jj] : last_[jj];
+      vel[jj] = vel_ok ? vel[jj] : last_vel_[jj];
+      toq[jj] = toq_ok ? toq[jj] : last_toq_[jj];
+      hit_invalid[jj] = (pos_ok ? 0.0 : 1.0) + (vel_ok ? 0.0 : 1.0) + (toq_ok ? 0.0 : 1.0);
+    }
+    for (std::size_t jj = 0; jj < N; jj++) {
+      double lower = last_[jj] - step_max_[jj];
+      double upper = last_[jj] + step_max_[jj];
+      double below = pos[jj] > upper ? upper : pos[jj];
+      double stepped = below < lower ? lower : below;
+      double inside = stepped > pos_max_[jj] ? pos_max_[jj] : stepped;
+      double clamped = inside < pos_min_[jj] ? pos_min_[jj] : inside;
+      hit_step[jj] = stepped != pos[jj] ? 1.0 : 0.0;
+      hit_pos[jj] = clamped != stepped ? 1.0 : 0.0;
+      pos[jj] = clamped;
+      last_[jj] = clamped;
+    }
+    for (std::size_t jj = 0; jj < N; jj++) {
+      double below = vel[jj] > vel_max_[jj] ? vel_max_[jj] : vel[jj];
+      double limited = below < -vel_max_[jj] ? -vel_max_[jj] : below;
+      hit_vel[jj] = limited != vel[jj] ? 1.0 : 0.0;
+      vel[jj] = limited;
+      last_vel_[jj] = limited;
+    }
+    for (std::size_t jj = 0; jj < N; jj++) {
+      double below = toq[jj] > toq_max_[jj] ? toq_max_[jj] : toq[jj];
+      double limited = below < -toq_max_[jj] ? -toq_max_[jj] : below;
+      hit_toq[jj] = limited != toq[jj] ? 1.0 : 0.0;
+      toq[jj] = limited;
+      last_toq_[jj] = limited;
+    }
+    has_last_ = true;
+
+    for (std::size_t jj = 0; jj < N; jj++) {
+      command.joints[jj].pos = pos[jj];
+      command.joints[jj].vel = vel[jj];
+      command.joints[jj].toq = toq[jj];
+    }
+
+    double any = 0.0;
+    for (std::size_t jj = 0; jj < N; jj++) {
+      any += hit_step[jj] + hit_pos[jj] + hit_vel[jj] + hit_toq[jj] + hit_invalid[jj];
+    }
+    Increment(commands_);
+    if (any == 0.0) {
+      return false;
+    }
+    Increment(limited_);
+    for (std::size_t jj = 0; jj < N; jj++) {
+      Add(counters_[jj].step, static_cast<uint64_t>(hit_step[jj]));
+      Add(counters_[jj].position, static_cast<uint64_t>(hit_pos[jj]));
+      Add(counters_[jj].velocity, static_cast<uint64_t>(hit_vel[jj]));
+      Add(counters_[jj].torque, static_cast<uint64_t>(hit_toq[jj]));
+      Add(counters_[jj].invalid, static_cast<uint64_t>(hit_invalid[jj]));
+    }
+    return true;
+  }
+
+  /**
+   * @brief Get limiter counters.
+   * @return Counters accumulated since construction or the last ResetStats.
+   */
+  JointLimiterStats GetStats() const {
+    JointLimiterStats stats;
+    stats.commands = commands_.load(std::memory_order_relaxed);
+    stats.limited = limited_.load(std::memory_order_relaxed);
+    stats.joints.resize(N);
+    for (std::size_t jj = 0; jj < N; jj++) {
+      stats.joints[jj].position = counters_[jj].position.load(std::memory_order_relaxed);
+      stats.joints[jj].velocity = counters_[jj].velocity.load(std::memory_order_relaxed);
+      stats.joints[jj].torque = counters_[jj].torque.load(std::memory_order_relaxed);
+      stats.joints[jj].step = counters_[jj].step.load(std::memory_order_relaxed);
+      stats.joints[jj].invalid = counters_[jj].invalid.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
+  /**
+   * @brief Clear limiter counters.
+   */
+  void ResetStats() {
+    commands_.store(0, std::memory_order_relaxed);
+    limited_.store(0, std::memory_order_relaxed);
+    for (auto& counter : counters_) {
+      counter.position.store(0, std::memory_order_relaxed);
+      counter.velocity.store(0, std::memory_order_relaxed);
+      counter.torque.store(0, std::memory_order_relaxed);
+      counter.step.store(0, std::memory_order_relaxed);
+      counter.invalid.store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  struct Counters {
+    std::atomic<uint64_t> position{0};
+    std::atomic<uint64_t> velocity{0};
+    std::atomic<uint64_t> torque{0};
+    std::atomic<uint64_t> step{0};
+    std::atomic<uint64_t> invalid{0};
+  };
+
+  // Single writer, a relaxed load and store is enough and avoids a locked instruction
+  static void Add(std::atomic<uint64_t>& counter, uint64_t value) { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+  static void Increment(std::atomic<uint64_t>& counter) { Add(counter, 1); }
+
+  alignas(64) Array pos_min_{};
+  alignas(64) Array pos_max_{};
+  alignas(64) Array vel_max_{};
+  alignas(64) Array toq_max_{};
+  alignas(64) Array step_max_{};
+  alignas(64) Array last_{};      // Previous limited target positions
+  alignas(64) Array last_vel_{};  // Previous limited target velocities
+  alignas(64) Array last_toq_{};  // Previous limited target torques
+  bool has_last_ = false;
+
+  std::atomic<uint64_t> commands_{0};
+  std::atomic<uint64_t> limited_{0};
+  std::array<Counters, N> counters_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "magic_histogram.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+template <typename Limb>
+class JointStatsAccumulator;
+template <typename Limb>
+using JointStatsAccumulatorPtr = std::shared_ptr<JointStatsAccumulator<Limb>>;
+
+/**
+ * @brief Histogram range of one joint state field
+ */
+struct JointStatsRange {
+  double lower = 0.0;  ///< Lower bound of the first bin
+  double upper = 0.0;  ///< Upper bound of the last bin
+};
+
+/**
+ * @brief Joint statistics accumulator configuration
+ */
+struct JointStatsOptions {
+  JointStatsRange vel{-20.0, 20.0};      ///< Velocity histogram range (unit: rad/s or m/s)
+  JointStatsRange toq{-200.0, 200.0};    ///< Torque histogram range (unit: Nm)
+  JointStatsRange current{-60.0, 60.0};  ///< Current histogram range (unit: A)
+  std::size_t histogram_bins = 64;       ///< Number of bins per joint and field
+};
+
+/**
+ * @brief Statistics of one joint state field over one window
+ */
+struct JointFieldStats {
+  RunningStats stats;           ///< Min, max, mean, variance and RMS
+  HistogramSnapshot histogram;  ///< Fixed-bin distribution
+};
+
+/**
+ * @brief Statistics of one joint over one window
+ */
+struct SingleJointStats {
+  JointFieldStats vel;      ///< Velocity (unit: rad/s or m/s)
+  JointFieldStats toq;      ///< Torque (unit: Nm)
+  JointFieldStats current;  ///< Current (unit: A)
+};
+
+/**
+ * @brief Statistics of all joints of a body part over one window
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct JointStatsSnapshot {
+  int64_t first_timestamp = 0;                           ///< Timestamp of the first sample in the window (unit: nanoseconds)
+  int64_t last_timestamp = 0;                            ///< Timestamp of the last sample in the window (unit: nanoseconds)
+  uint64_t samples = 0;                                  ///< Joint state messages folded into the window
+  std::array<SingleJointStats, Limb::kJointNum> joints;  ///< Per-joint statistics, in state order
+};
+
+/**
+ * @class JointStatsAccumulator
+ * @brief Folds a joint state stream into per-joint running statistics for thermal and wear monitoring.
+ *
+ * Every sample updates, per joint, the min, max, mean, Welford variance and RMS of the velocity, torque and current,
+ * and a fixed-bin histogram of each. No history is stored and Add never allocates. SnapshotAndReset hands the
+ * current window to the caller and starts a new one; the window storage is swapped, so the receive thread is only
+ * held up for a pointer swap. Non-finite samples are counted as invalid and left out of the statistics and bins. A
+ * field whose range is not finite or empty (see IsValid) still gets its statistics, but its histogram counts every
+ * sample as invalid.
+ *
+ * Feed it the structure-of-arrays joint state, e.g. from a LowLevelStateHub listener:
+ * @code
+ * hub.AddJointStateSoAListener<ArmLimb>([stats](const ArmJointStateSoA& state) { stats->Add(state); });
+ * @endcode
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+class JointStatsAccumulator final : public NonCopyable {
+  static constexpr std::size_t N = Limb::kJointNum;
+
+  enum Field : std::size_t { kVel = 0, kToq, kCurrent, kFieldNum };
+
+  // Running statistics and histogram bins of one field for all joints
+  struct FieldWindow {
+    std::array<RunningStats, N> stats{};
+    std::vector<uint64_t> bins;  // N * bin count, joint-major
+    std::array<uint64_t, N> underflow{};
+    std::array<uint64_t, N> overflow{};
+  };
+
+  struct Window {
+    int64_t first_timestamp = 0;
+    int64_t last_timestamp = 0;
+    uint64_t samples = 0;
+    std::array<FieldWindow, kFieldNum> fields;
+  };
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param options Histogram ranges.
+   */
+  explicit JointStatsAccumulator(const JointStatsOptions& options = {})
+      : ranges_{options.vel, options.toq, options.current},
+        valid_{IsValid(options.vel), IsValid(options.toq), IsValid(options.current)},
+        bin_count_(std::max<std::size_t>(options.histogram_bins, 1)),
+        active_(MakeWindow()),
+        spare_(MakeWindow()) {}
+
+  /**
+   * @brief Fold one joint state sample into the current window.
+   * @param state Joint state of the body part.
+   * @note Meant for one feeding thread, may run concurrently with SnapshotAndReset.
+   */
+  void Add(const JointStateSoA<Limb>& state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Window& window = *active_;
+    if (window.samples == 0) {
+      window.first_timestamp = state.timestamp;
+    }
+    window.last_timestamp = state.timestamp;
+    window.samples++;
+    Fold(window.fields[kVel], kVel, state.vel);
+    Fold(window.fields[kToq], kToq, state.toq);
+    Fold(window.fields[kCurrent], kCurrent, state.current);
+  }
+
+  /**
+   * @brief Whether every histogram range is finite and not empty.
+   */
+  bool IsValid() const { return valid_[kVel] && valid_[kToq] && valid_[kCurrent]; }
+
+  /**
+   * @brief Take the statistics of the current window and start a new one.
+   * @return Statistics since construction or the previous SnapshotAndReset.
+   */
+  JointStatsSnapshot<Limb> SnapshotAndReset() {
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::swap(active_, spare_);
+    }
+    Window& window = *spare_;
+    JointStatsSnapshot<Limb> snapshot;
+    snapshot.first_timestamp = window.first_timestamp;
+    snapshot.last_timestamp = window.last_timestamp;
+    snapshot.samples = window.samples;
+    for (std::size_t jj = 0; jj < N; jj++) {
+      snapshot.joints[jj].vel = MakeFieldStats(window.fields[kVel], kVel, jj);
+      snapshot.joints[jj].toq = MakeFieldStats(window.fields[kToq], kToq, jj);
+      snapshot.joints[jj].current = MakeFieldStats(window.fields[kCurrent], kCurrent, jj);
+    }
+    Clear(window);
+    return snapshot;
+  }
+
+ private:
+  static bool IsValid(const JointStatsRange& range) { return gen1::detail::IsValidHistogramRange(range.lower, range.upper); }
+
+  std::unique_ptr<Window> MakeWindow() const {
+    auto window = std::make_unique<Window>();
+    for (auto& field : window->fields) {
+      field.bins.assign(N * bin_count_, 0);
+    }
+    return window;
+  }
+
+  static void Clear(Window& window) {
+    window.first_timestamp = 0;
+    window.last_timestamp = 0;
+    window.samples = 0;
+    for (auto& field : window.fields) {
+      field.stats.fill(RunningStats{});
+      std::fill(field.bins.begin(), field.bins.end(), 0);
+      field.underflow.fill(0);
+      field.overflow.fill(0);
+    }
+  }
+
+  void Fold(FieldWindow& field, Field index, const std::array<double, N>& values) const {
+    const JointStatsRange& range = ranges_[index];
+    double bin_width = (range.upper - range.lower) / static_cast<double>(bin_count_);
+    for (std::size_t jj = 0; jj < N; jj++) {
+      double value = values[jj];
+      field.stats[jj].Add(value);  // counts a non-finite value as invalid
+      if (!valid_[index] || !std::isfinite(value)) {
+        continue;
+      }
+      if (value < range.lower) {
+        field.underflow[jj]++;
+        continue;
+      }
+      // Compared as a double first, converting an out-of-range value to an integer is undefined
+      double position = (value - range.lower) / bin_width;
+      if (position < static_cast<double>(bin_count_)) {
+        field.bins[jj * bin_count_ + static_cast<std::size_t>(position)]++;
+      } else {
+        field.overflow[jj]++;
+      }
+    }
+  }
+
+  JointFieldStats MakeFieldStats(const FieldWindow& field, Field index, std::size_t joint) const {
+    JointFieldStats result;
+    const RunningStats& stats = field.stats[joint];
+    result.stats = stats;
+    HistogramSnapshot& histogram = result.histogram;
+    auto first = field.bins.begin() + static_cast<std::ptrdiff_t>(joint * bin_count_);
+    histogram.bins.assign(first, first + static_cast<std::ptrdiff_t>(bin_count_));
+    if (!valid_[index]) {
+      // Same content as a Histogram constructed with the invalid range
+      histogram.invalid = stats.invalid + stats.count;
+      return result;
+    }
+    const JointStatsRange& range = ranges_[index];
+    histogram.lower = range.lower;
+    histogram.bin_width = (range.upper - range.lower) / static_cast<double>(bin_count_);
+    histogram.underflow = field.underflow[joint];
+    histogram.overflow = field.overflow[joint];
+    histogram.count = stats.count;
+    histogram.invalid = stats.invalid;
+    histogram.min = stats.min;
+    histogram.max = stats.max;
+    histogram.mean = stats.mean;
+    return result;
+  }
+
+  const std::array<JointStatsRange, kFieldNum> ranges_;
+  const std::array<bool, kFieldNum> valid_;  // Range of the field is usable, otherwise its histogram stays empty
+  const std::size_t bin_count_;
+
+  std::mutex snapshot_mutex_;  // Serializes SnapshotAndReset, which owns spare_
+  std::mutex mutex_;           // Guards active_
+  std::unique_ptr<Window> active_;
+  std::unique_ptr<Window> spare_;
+};
+
+using ArmJointStatsAccumulator = JointStatsAccumulator<ArmLimb>;      ///< Upper limbs statistics
+using LegJointStatsAccumulator = JointStatsAccumulator<LegLimb>;      ///< Lower limbs statistics
+using HeadJointStatsAccumulator = JointStatsAccumulator<HeadLimb>;    ///< Head statistics
+using WaistJointStatsAccumulator = JointStatsAccumulator<WaistLimb>;  ///< Waist statistics
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
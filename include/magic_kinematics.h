@@ -0,0 +1,580 @@
+#pragma once
+
+#include "magic_type.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+
+namespace magic::gen1::kinematics {
+
+using Vector3 = std::array<double, 3>;  ///< x, y, z
+
+/**
+ * @brief Rigid transform, rotation followed by translation
+ */
+struct Transform {
+  std::array<double, 9> rotation{1, 0, 0, 0, 1, 0, 0, 0, 1};  ///< Rotation matrix, row-major
+  Vector3 translation{};                                      ///< Translation (unit: m)
+
+  /// Identity transform
+  static Transform Identity() { return {}; }
+
+  /**
+   * @brief Transform from a URDF origin.
+   * @param xyz Translation (unit: m).
+   * @param rpy Fixed-axis roll, pitch and yaw (unit: rad), applied about x, then y, then z.
+   */
+  static Transform FromXyzRpy(const Vector3& xyz, const Vector3& rpy) {
+    double cr = std::cos(rpy[0]), sr = std::sin(rpy[0]);
+    double cp = std::cos(rpy[1]), sp = std::sin(rpy[1]);
+    double cy = std::cos(rpy[2]), sy = std::sin(rpy[2]);
+    Transform transform;
+    transform.rotation = {cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr,
+                          sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr,
+                          -sp, cp * sr, cp * cr};
+    transform.translation = xyz;
+    return transform;
+  }
+
+  /**
+   * @brief Rotation about a unit axis.
+   * @param axis Unit rotation axis.
+   * @param angle Rotation angle (unit: rad).
+   */
+  static Transform FromAxisAngle(const Vector3& axis, double angle) {
+    Transform transform;
+    transform.rotation = AxisAngleRotation(axis, std::cos(angle), std::sin(angle));
+    return transform;
+  }
+
+  /// Compose, the result maps a point first through other, then through this transform
+  Transform operator*(const Transform& other) const {
+    Transform result;
+    result.rotation = Multiply(rotation, other.rotation);
+    result.translation = Apply(other.translation);
+    return result;
+  }
+
+  /// Transform a point
+  Vector3 Apply(const Vector3& point) const {
+    Vector3 rotated = Rotate(point);
+    return {rotated[0] + translation[0], rotated[1] + translation[1], rotated[2] + translation[2]};
+  }
+
+  /// Rotate a direction, the translation is ignored
+  Vector3 Rotate(const Vector3& direction) const {
+    const auto& r = rotation;
+    return {r[0] * direction[0] + r[1] * direction[1] + r[2] * direction[2],
+            r[3] * direction[0] + r[4] * direction[1] + r[5] * direction[2],
+            r[6] * direction[0] + r[7] * direction[1] + r[8] * direction[2]};
+  }
+
+  /// Inverse transform
+  Transform Inverse() const {
+    Transform inverse;
+    const auto& r = rotation;
+    inverse.rotation = {r[0], r[3], r[6], r[1], r[4], r[7], r[2], r[5], r[8]};
+    Vector3 rotated = inverse.Rotate(translation);
+    inverse.translation = {-rotated[0], -rotated[1], -rotated[2]};
+    return inverse;
+  }
+
+  /// Product of two row-major rotation matrices
+  static std::array<double, 9> Multiply(const std::array<double, 9>& a, const std::array<double, 9>& b) {
+    std::array<double, 9> c;
+    for (int row = 0; row < 3; row++) {
+      for (int col = 0; col < 3; col++) {
+        c[row * 3 + col] = a[row * 3] * b[col] + a[row * 3 + 1] * b[3 + col] + a[row * 3 + 2] * b[6 + col];
+      }
+    }
+    return c;
+  }
+
+  /// Rodrigues rotation matrix about a unit axis from the cosine and sine of the angle
+  static std::array<double, 9> AxisAngleRotation(const Vector3& axis, double c, double s) {
+    double t = 1.0 - c;
+    double x = axis[0], y = axis[1], z = axis[2];
+    return {t * x * x + c, t * x * y - s * z, t * x * z + s * y,
+            t * x * y + s * z, t * y * y + c, t * y * z - s * x,
+            t * x * z - s * y, t * y * z + s * x, t * z * z + c};
+  }
+};
+
+/**
+ * @brief Joint motion type
+ */
+enum class JointType : int8_t {
+  REVOLUTE = 0,   ///< Rotation about the axis, position in rad
+  PRISMATIC = 1,  ///< Translation along the axis, position in m
+};
+
+/**
+ * @brief Mass properties of one link, in URDF convention
+ */
+struct LinkInertia {
+  double mass = 0.0;                ///< Mass (unit: kg)
+  Vector3 com{};                    ///< Center of mass in the link frame (unit: m)
+  std::array<double, 9> inertia{};  ///< Rotational inertia about the center of mass, link frame axes, row-major (unit: kg*m^2)
+};
+
+/**
+ * @brief One actuated joint of a kinematic chain, in URDF convention
+ */
+struct ChainJoint {
+  std::size_t index = 0;                 ///< Joint index in the body part's joint command and state
+  JointType type = JointType::REVOLUTE;  ///< Joint motion type
+  Transform origin;                      ///< Joint frame in the previous link frame at zero position (URDF joint origin)
+  Vector3 axis{0, 0, 1};                 ///< Joint axis in the joint frame (URDF joint axis)
+  LinkInertia link;                      ///< Mass properties of the link moved by the joint (URDF child link inertial), used by dynamics only
+};
+
+/**
+ * @brief Serial kinematic chain of one limb
+ *
+ * The SDK does not ship the Gen1 link geometry, fill the joints from the robot description (URDF) of the firmware in
+ * use. Link i is the frame of joint i after its motion; the tip is a fixed tool frame on the last link.
+ *
+ * @tparam Limb Limb descriptor whose joint state drives the chain (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ * @tparam N Number of joints in the chain.
+ */
+template <typename Limb, std::size_t N>
+struct ChainDescriptor {
+  using LimbType = Limb;                      ///< Limb descriptor
+  static constexpr std::size_t kLinkNum = N;  ///< Number of joints and links
+
+  Transform base;                    ///< Chain root in the reference frame (e.g. the pelvis or torso frame)
+  std::array<ChainJoint, N> joints;  ///< Joints from the root to the tip
+  Transform tip;                     ///< Tool frame in the last link frame
+
+  /**
+   * @brief Chain driven by consecutive joints of the body part.
+   * @param first Index of the first chain joint, e.g. ArmLimb::kRightJoint1.
+   * @return Chain with the joint indices set and identity geometry.
+   */
+  static ChainDescriptor Indexed(std::size_t first) {
+    static_assert(N <= Limb::kJointNum, "chain is longer than the body part");
+    ChainDescriptor chain;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      chain.joints[ii].index = first + ii;
+    }
+    return chain;
+  }
+};
+
+using ArmChain = ChainDescriptor<ArmLimb, ArmLimb::kJointsPerSide>;  ///< One arm, 7 joints
+using LegChain = ChainDescriptor<LegLimb, LegLimb::kJointsPerSide>;  ///< One leg, 6 joints
+using HeadChain = ChainDescriptor<HeadLimb, HeadLimb::kJointNum>;    ///< Head, 2 joints
+
+/**
+ * @class ForwardKinematics
+ * @brief Link poses of a serial chain, with the chain length fixed at compile time.
+ *
+ * Compute evaluates every link; Update only re-evaluates the links at and after the first joint whose position
+ * changed since the previous call, which makes small changes at the distal joints (wrist, ankle) cheap. ComputeBatch
+ * evaluates many configurations without touching the cached poses.
+ *
+ * Not thread-safe; use one instance per thread. ComputeBatch is const and may run concurrently with itself.
+ *
+ * @tparam Limb Limb descriptor whose joint state drives the chain.
+ * @tparam N Number of joints in the chain.
+ */
+template <typename Limb, std::size_t N>
+class ForwardKinematics final {
+ public:
+  using Chain = ChainDescriptor<Limb, N>;   ///< Chain descriptor
+  using Positions = std::array<double, N>;  ///< Joint positions in chain order
+
+  /**
+   * @brief Constructor.
+   * @param chain Chain descriptor, joint axes are normalized.
+   */
+  explicit ForwardKinematics(const Chain& chain) : chain_(chain) {
+    for (auto& joint : chain_.joints) {
+      double norm = std::sqrt(joint.axis[0] * joint.axis[0] + joint.axis[1] * joint.axis[1] + joint.axis[2] * joint.axis[2]);
+      if (norm > 0.0) {
+        joint.axis = {joint.axis[0] / norm, joint.axis[1] / norm, joint.axis[2] / norm};
+      }
+    }
+  }
+
+  /// Chain descriptor with normalized axes
+  const Chain& GetChain() const { return chain_; }
+
+  /**
+   * @brief Move the chain root, e.g. to follow the waist; every link is re-evaluated on the next Update.
+   * @param base Chain root in the reference frame.
+   */
+  void SetBase(const Transform& base) {
+    chain_.base = base;
+    valid_ = 0;
+  }
+
+  /**
+   * @brief Evaluate every link.
+   * @param positions Joint positions in chain order.
+   */
+  void Compute(const Positions& positions) {
+    valid_ = 0;
+    Update(positions);
+  }
+
+  /**
+   * @brief Re-evaluate the links at and after the first joint whose position changed.
+   * @param positions Joint positions in chain order, compared exactly with the previous call.
+   * @return Number of links evaluated, 0 if nothing changed.
+   */
+  std::size_t Update(const Positions& positions) {
+    std::size_t first = 0;
+    while (first < valid_ && positions[first] == positions_[first]) {
+      first++;
+    }
+    if (first == N && valid_ == N) {
+      return 0;
+    }
+    Transform parent = first == 0 ? chain_.base : links_[first - 1];
+    for (std::size_t ii = first; ii < N; ii++) {
+      links_[ii] = parent * JointTransform(chain_.joints[ii], positions[ii]);
+      positions_[ii] = positions[ii];
+      parent = links_[ii];
+    }
+    tip_ = parent * chain_.tip;
+    valid_ = N;
+    return N - first;
+  }
+
+  /**
+   * @brief Update from a joint state message of the body part, using the low encoder positions.
+   * @param state Joint state.
+   * @return Number of links evaluated, 0 if nothing changed or the message has too few joints.
+   */
+  std::size_t Update(const JointState& state) {
+    Positions positions;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      std::size_t index = chain_.joints[ii].index;
+      if (index >= state.joints.size()) {
+        return 0;
+      }
+      positions[ii] = state.joints[index].posL;
+    }
+    return Update(positions);
+  }
+
+  /**
+   * @brief Update from a fixed-size joint state of the body part, using the low encoder positions.
+   * @param state Joint state.
+   * @return Number of links evaluated, 0 if nothing changed.
+   */
+  std::size_t Update(const JointStateT<Limb>& state) {
+    Positions positions;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      positions[ii] = state.joints[chain_.joints[ii].index].posL;
+    }
+    return Update(positions);
+  }
+
+  /**
+   * @brief Update from a structure-of-arrays joint state of the body part, using the low encoder positions.
+   * @param state Joint state.
+   * @return Number of links evaluated, 0 if nothing changed.
+   */
+  std::size_t Update(const JointStateSoA<Limb>& state) {
+    Positions positions;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      positions[ii] = state.posL[chain_.joints[ii].index];
+    }
+    return Update(positions);
+  }
+
+  /**
+   * @brief Pose of a link in the reference frame, from the last Compute or Update.
+   * @param link Link index in chain order, [0, N).
+   */
+  const Transform& LinkPose(std::size_t link) const { return links_[link]; }
+
+  /**
+   * @brief Pose of the tool frame in the reference frame, from the last Compute or Update.
+   */
+  const Transform& TipPose() const { return tip_; }
+
+  /**
+   * @brief Joint positions of the last Compute or Update.
+   */
+  const Positions& GetPositions() const { return positions_; }
+
+  /**
+   * @brief Joint axis of a link in the reference frame.
+   * @param link Link index in chain order, [0, N).
+   */
+  Vector3 JointAxis(std::size_t link) const { return links_[link].Rotate(chain_.joints[link].axis); }
+
+  /**
+   * @brief Evaluate the tool frame for many configurations, the cached poses are not changed.
+   * @param configurations Joint positions of every configuration, in chain order.
+   * @param[out] tips Tool frame of every configuration.
+   * @return Number of configurations evaluated, the smaller of the two sizes.
+   */
+  std::size_t ComputeBatch(std::span<const Positions> configurations, std::span<Transform> tips) const {
+    std::size_t count = std::min(configurations.size(), tips.size());
+    for (std::size_t cc = 0; cc < count; cc++) {
+      Transform pose = chain_.base;
+      for (std::size_t ii = 0; ii < N; ii++) {
+        pose = pose * JointTransform(chain_.joints[ii], configurations[cc][ii]);
+      }
+      tips[cc] = pose * chain_.tip;
+    }
+    return count;
+  }
+
+ private:
+  // Joint frame motion composed with its origin
+  static Transform JointTransform(const ChainJoint& joint, double position) {
+    Transform local;
+    if (joint.type == JointType::REVOLUTE) {
+      local.rotation = Transform::Multiply(joint.origin.rotation, Transform::AxisAngleRotation(joint.axis, std::cos(position), std::sin(position)));
+      local.translation = joint.origin.translation;
+    } else {
+      Vector3 offset = joint.origin.Rotate(joint.axis);
+      local.rotation = joint.origin.rotation;
+      local.translation = {joint.origin.translation[0] + offset[0] * position,
+                           joint.origin.translation[1] + offset[1] * position,
+                           joint.origin.translation[2] + offset[2] * position};
+    }
+    return local;
+  }
+
+  Chain chain_;
+  Positions positions_{};           // Positions of the cached links
+  std::array<Transform, N> links_;  // Link poses in the reference frame
+  Transform tip_;
+  std::size_t valid_ = 0;  // Links [0, valid_) match positions_
+};
+
+using ArmForwardKinematics = ForwardKinematics<ArmLimb, ArmLimb::kJointsPerSide>;  ///< One arm
+using LegForwardKinematics = ForwardKinematics<LegLimb, LegLimb::kJointsPerSide>;  ///< One leg
+using HeadForwardKinematics = ForwardKinematics<HeadLimb, HeadLimb::kJointNum>;    ///< Head
+
+/**
+ * @brief Inverse kinematics solver configuration
+ */
+struct IkOptions {
+  int max_iterations = 8;               ///< Iteration cap per solve, bounds the solve time
+  double damping = 0.05;                ///< Damping factor lambda of the least-squares step
+  double position_tolerance = 1e-4;     ///< Converged below this position error (unit: m)
+  double orientation_tolerance = 1e-3;  ///< Converged below this orientation error (unit: rad)
+  double orientation_weight = 0.5;      ///< Weight of orientation error against position error (unit: m/rad), 0 solves position only
+  double max_step = 0.2;                ///< Largest joint change per iteration (unit: rad or m)
+};
+
+/**
+ * @brief Inverse kinematics solve result
+ */
+struct IkResult {
+  bool converged = false;          ///< Both errors are below their tolerances
+  int iterations = 0;              ///< Iterations run
+  double position_error = 0.0;     ///< Remaining tool position error (unit: m)
+  double orientation_error = 0.0;  ///< Remaining tool orientation error (unit: rad)
+};
+
+/**
+ * @brief Rotation vector (axis times angle) of a rotation matrix.
+ * @param rotation Row-major rotation matrix.
+ * @return Rotation vector (unit: rad).
+ */
+inline Vector3 RotationVector(const std::array<double, 9>& rotation) {
+  const auto& r = rotation;
+  Vector3 vee{r[7] - r[5], r[2] - r[6], r[3] - r[1]};
+  double angle = std::acos(std::clamp((r[0] + r[4] + r[8] - 1.0) * 0.5, -1.0, 1.0));
+  if (angle < 1e-6) {
+    return {0.5 * vee[0], 0.5 * vee[1], 0.5 * vee[2]};
+  }
+  if (angle > std::numbers::pi - 1e-6) {
+    // Half turn, the axis comes from the largest diagonal element
+    int k = r[0] >= r[4] && r[0] >= r[8] ? 0 : (r[4] >= r[8] ? 1 : 2);
+    Vector3 axis;
+    axis[k] = std::sqrt(std::max((r[k * 4] + 1.0) * 0.5, 0.0));
+    for (int ii = 0; ii < 3; ii++) {
+      if (ii != k) {
+        axis[ii] = (r[k * 3 + ii] + r[ii * 3 + k]) / (4.0 * axis[k]);
+      }
+    }
+    return {axis[0] * angle, axis[1] * angle, axis[2] * angle};
+  }
+  double scale = angle / (2.0 * std::sin(angle));
+  return {vee[0] * scale, vee[1] * scale, vee[2] * scale};
+}
+
+/**
+ * @class InverseKinematics
+ * @brief Damped least-squares inverse kinematics of the tool frame of a serial chain.
+ *
+ * Every iteration builds the 6xN geometric Jacobian from the forward kinematics, solves the 6x6 damped normal
+ * equations with a Cholesky factorization and applies the joint step, scaled down to max_step and clamped to the joint
+ * limits. The cost per iteration is fixed, so max_iterations bounds the solve time. Seeding with the measured or
+ * previous joint positions (warm start) usually converges within a few iterations at control rate.
+ *
+ * @tparam Limb Limb descriptor whose joint state drives the chain.
+ * @tparam N Number of joints in the chain.
+ */
+template <typename Limb, std::size_t N>
+class InverseKinematics final {
+ public:
+  using Chain = ChainDescriptor<Limb, N>;   ///< Chain descriptor
+  using Positions = std::array<double, N>;  ///< Joint positions in chain order
+
+  /**
+   * @brief Constructor.
+   * @param chain Chain descriptor.
+   * @param options Solver configuration.
+   */
+  explicit InverseKinematics(const Chain& chain, const IkOptions& options = {}) : fk_(chain), options_(options) {
+    lower_.fill(-std::numeric_limits<double>::infinity());
+    upper_.fill(std::numeric_limits<double>::infinity());
+  }
+
+  /**
+   * @brief Move the chain root, e.g. to follow the waist.
+   * @param base Chain root in the reference frame.
+   */
+  void SetBase(const Transform& base) { fk_.SetBase(base); }
+
+  /**
+   * @brief Set the joint position limits, unlimited by default.
+   * @param lower Lower limits in chain order.
+   * @param upper Upper limits in chain order.
+   */
+  void SetLimits(const Positions& lower, const Positions& upper) {
+    lower_ = lower;
+    upper_ = upper;
+  }
+
+  /// Solver configuration
+  const IkOptions& GetOptions() const { return options_; }
+
+  /// Forward kinematics at the last evaluated positions
+  const ForwardKinematics<Limb, N>& GetForwardKinematics() const { return fk_; }
+
+  /**
+   * @brief Solve for a tool frame pose.
+   * @param target Tool frame pose in the reference frame.
+   * @param[in,out] positions Seed positions in chain order, replaced by the solution.
+   * @return Convergence, iterations and remaining errors.
+   */
+  IkResult Solve(const Transform& target, Positions& positions) {
+    IkResult result;
+    for (std::size_t ii = 0; ii < N; ii++) {
+      positions[ii] = std::clamp(positions[ii], lower_[ii], upper_[ii]);
+    }
+    fk_.Update(positions);
+    const double weight = options_.orientation_weight;
+    while (true) {
+      const Transform& tip = fk_.TipPose();
+      std::array<double, 6> error;
+      Vector3 rotation = RotationVector(Transform::Multiply(target.rotation, tip.Inverse().rotation));
+      for (int kk = 0; kk < 3; kk++) {
+        error[kk] = target.translation[kk] - tip.translation[kk];
+        error[3 + kk] = rotation[kk] * weight;
+      }
+      result.position_error = std::sqrt(error[0] * error[0] + error[1] * error[1] + error[2] * error[2]);
+      result.orientation_error = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2]);
+      result.converged = result.position_error <= options_.position_tolerance && (weight == 0.0 || result.orientation_error <= options_.orientation_tolerance);
+      if (result.converged || result.iterations >= options_.max_iterations) {
+        return result;
+      }
+
+      // Geometric Jacobian, one 6-vector column per joint
+      std::array<std::array<double, 6>, N> jacobian;
+      for (std::size_t ii = 0; ii < N; ii++) {
+        Vector3 axis = fk_.JointAxis(ii);
+        auto& column = jacobian[ii];
+        if (fk_.GetChain().joints[ii].type == JointType::REVOLUTE) {
+          const Vector3& origin = fk_.LinkPose(ii).translation;
+          Vector3 arm{tip.translation[0] - origin[0], tip.translation[1] - origin[1], tip.translation[2] - origin[2]};
+          column = {axis[1] * arm[2] - axis[2] * arm[1], axis[2] * arm[0] - axis[0] * arm[2], axis[0] * arm[1] - axis[1] * arm[0],
+                    axis[0] * weight, axis[1] * weight, axis[2] * weight};
+        } else {
+          column = {axis[0], axis[1], axis[2], 0.0, 0.0, 0.0};
+        }
+      }
+
+      // (J J^T + lambda^2 I) y = e, then dq = J^T y
+      std::array<double, 36> normal{};
+      for (int row = 0; row < 6; row++) {
+        for (int col = 0; col <= row; col++) {
+          double sum = row == col ? options_.damping * options_.damping : 0.0;
+          for (std::size_t ii = 0; ii < N; ii++) {
+            sum += jacobian[ii][row] * jacobian[ii][col];
+          }
+          normal[row * 6 + col] = sum;
+        }
+      }
+      std::array<double, 6> y = SolveCholesky(normal, error);
+      Positions step;
+      double largest = 0.0;
+      for (std::size_t ii = 0; ii < N; ii++) {
+        double sum = 0.0;
+        for (int kk = 0; kk < 6; kk++) {
+          sum += jacobian[ii][kk] * y[kk];
+        }
+        step[ii] = sum;
+        largest = std::max(largest, std::fabs(sum));
+      }
+      double scale = largest > options_.max_step ? options_.max_step / largest : 1.0;
+      for (std::size_t ii = 0; ii < N; ii++) {
+        positions[ii] = std::clamp(positions[ii] + step[ii] * scale, lower_[ii], upper_[ii]);
+      }
+      fk_.Update(positions);
+      result.iterations++;
+    }
+  }
+
+ private:
+  // Solve A x = b for a symmetric positive definite 6x6 matrix, only the lower triangle of A is read
+  static std::array<double, 6> SolveCholesky(std::array<double, 36>& a, const std::array<double, 6>& b) {
+    for (int col = 0; col < 6; col++) {
+      double diagonal = a[col * 6 + col];
+      for (int kk = 0; kk < col; kk++) {
+        diagonal -= a[col * 6 + kk] * a[col * 6 + kk];
+      }
+      diagonal = std::sqrt(std::max(diagonal, 1e-12));
+      a[col * 6 + col] = diagonal;
+      for (int row = col + 1; row < 6; row++) {
+        double sum = a[row * 6 + col];
+        for (int kk = 0; kk < col; kk++) {
+          sum -= a[row * 6 + kk] * a[col * 6 + kk];
+        }
+        a[row * 6 + col] = sum / diagonal;
+      }
+    }
+    std::array<double, 6> x;
+    for (int row = 0; row < 6; row++) {
+      double sum = b[row];
+      for (int kk = 0; kk < row; kk++) {
+        sum -= a[row * 6 + kk] * x[kk];
+      }
+      x[row] = sum / a[row * 6 + row];
+    }
+    for (int row = 5; row >= 0; row--) {
+      double sum = x[row];
+      for (int kk = row + 1; kk < 6; kk++) {
+        sum -= a[kk * 6 + row] * x[kk];
+      }
+      x[row] = sum / a[row * 6 + row];
+    }
+    return x;
+  }
+
+  ForwardKinematics<Limb, N> fk_;
+  const IkOptions options_;
+  Positions lower_;
+  Positions upper_;
+};
+
+using ArmInverseKinematics = InverseKinematics<ArmLimb, ArmLimb::kJointsPerSide>;  ///< One arm
+
+}  // namespace magic::gen1::kinematics
\ No newline at end of file
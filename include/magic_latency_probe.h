@@ -0,0 +1,211 @@
+#pragma once
+
+#include "magic_histogram.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+class RoundTripProbe;
+using RoundTripProbePtr = std::shared_ptr<RoundTripProbe>;
+
+/**
+ * @brief Round-trip probe configuration
+ */
+struct RoundTripProbeOptions {
+  std::size_t window = 1024;              ///< Number of most recent round trips kept for the latency distribution
+  std::size_t max_in_flight = 64;         ///< Commands awaiting their state echo, the oldest one is dropped when full
+  int64_t timeout_ns = 200000000;         ///< A command not echoed within this time is counted as lost (unit: nanoseconds)
+  int64_t histogram_range_ns = 20000000;  ///< Range of the latency histogram (unit: nanoseconds)
+  std::size_t histogram_bins = 200;       ///< Number of histogram bins
+};
+
+/**
+ * @brief Round-trip probe counters and latency distribution (unit: nanoseconds)
+ */
+struct RoundTripStats {
+  uint64_t sent = 0;          ///< Commands registered with the probe
+  uint64_t matched = 0;       ///< Commands whose echo was observed in a state message
+  uint64_t lost = 0;          ///< Commands timed out, superseded by a newer echo or dropped from a full queue
+  bool echo_matched = false;  ///< A command was matched since construction; while false, lost reflects the matcher, not the link
+  HistogramSnapshot latency;  ///< Command-to-state latency over the most recent window
+};
+
+/**
+ * @class RoundTripProbe
+ * @brief Correlates published joint commands with the state messages that reflect them.
+ *
+ * Every command is registered with an echo id (by default its timestamp) and the send time. When a state message of
+ * the same body part satisfies the matcher for a pending echo id, the elapsed time is recorded as one round trip.
+ * Pending commands older than the matched one are counted as lost, since the state stream is in order.
+ *
+ * The probe is opt-in: attach it to a LowLevelCommandPublisher with SetRoundTripProbe and feed it the joint states,
+ * e.g. from a LowLevelStateHub listener:
+ * @code
+ * hub.AddJointStateListener([probe](BodyPartMask part, const std::shared_ptr<JointState>& state) { probe->OnStateReceived(part, *state); });
+ * @endcode
+ * The default matcher requires the state messages to carry the command timestamp, which only LoopbackMotionController
+ * does so the probe can be exercised without a robot; the robot firmware does not echo it, so pass a matcher that
+ * recognizes the commanded values in the state there. As long as RoundTripStats::echo_matched is false, every command
+ * ends up lost because the matcher never fires, not because of the link.
+ *
+ * OnCommandSent runs on the publishing thread and OnStateReceived on the receive thread, they share a
+ * priority-inheriting mutex so that a real-time publisher cannot be stalled by a preempted receive thread.
+ */
+class RoundTripProbe final : public NonCopyable {
+  // Returns whether the state message reflects the command registered with echo_id
+  using Matcher = std::function<bool(int64_t echo_id, const JointState& state)>;
+
+  struct Pending {
+    BodyPartMask part = kBodyPartNone;
+    int64_t echo_id = 0;
+    int64_t sent_ns = 0;
+  };
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param options Probe configuration.
+   * @param matcher Correlation rule, defaults to MatchEchoedTimestamp, which only matches on LoopbackMotionController.
+   */
+  explicit RoundTripProbe(const RoundTripProbeOptions& options = {}, Matcher matcher = nullptr)
+      : options_(options),
+        matcher_(matcher ? std::move(matcher) : Matcher(&RoundTripProbe::MatchEchoedTimestamp)),
+        pending_(std::max<std::size_t>(options.max_in_flight, 1)),
+        window_(std::max<std::size_t>(options.window, 1)) {}
+
+  /**
+   * @brief Default matcher, the state message carries the timestamp of the command it reflects.
+   * @param echo_id Command timestamp.
+   * @param state Joint state message.
+   * @return Whether the state timestamp equals the command timestamp.
+   */
+  static bool MatchEchoedTimestamp(int64_t echo_id, const JointState& state) { return state.timestamp == echo_id; }
+
+  /**
+   * @brief Register a command right before it is published.
+   * @param part Body part of the command.
+   * @param echo_id Id the robot side reflects back, usually the command timestamp.
+   */
+  void OnCommandSent(BodyPartMask part, int64_t echo_id) {
+    int64_t now = detail::SteadyNowNs();
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    ExpirePending(now);
+    if (pending_size_ == pending_.size()) {
+      pending_head_ = (pending_head_ + 1) % pending_.size();
+      pending_size_--;
+      lost_++;
+    }
+    pending_[(pending_head_ + pending_size_) % pending_.size()] = {part, echo_id, now};
+    pending_size_++;
+    sent_++;
+  }
+
+  /**
+   * @brief Correlate a received state message with the pending commands.
+   * @param part Body part of the state message.
+   * @param state Joint state message.
+   */
+  void OnStateReceived(BodyPartMask part, const JointState& state) {
+    int64_t now = detail::SteadyNowNs();
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    ExpirePending(now);
+    for (std::size_t ii = pending_size_; ii-- > 0;) {
+      const Pending& entry = pending_[(pending_head_ + ii) % pending_.size()];
+      if (entry.part != part || !matcher_(entry.echo_id, state)) {
+        continue;
+      }
+      window_[window_next_] = now - entry.sent_ns;
+      window_next_ = (window_next_ + 1) % window_.size();
+      window_size_ = std::min(window_size_ + 1, window_.size());
+      matched_++;
+      echo_matched_ = true;
+      RemoveUpTo(part, ii);
+      return;
+    }
+  }
+
+  /**
+   * @brief Get probe counters and the latency distribution of the most recent round trips.
+   * @return Round-trip statistics.
+   */
+  RoundTripStats GetStats() const {
+    Histogram histogram(0.0, static_cast<double>(options_.histogram_range_ns), options_.histogram_bins);
+    RoundTripStats stats;
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+      stats.sent = sent_;
+      stats.matched = matched_;
+      stats.lost = lost_;
+      stats.echo_matched = echo_matched_;
+      for (std::size_t ii = 0; ii < window_size_; ii++) {
+        histogram.Record(static_cast<double>(window_[ii]));
+      }
+    }
+    stats.latency = histogram.Snapshot();
+    return stats;
+  }
+
+  /**
+   * @brief Clear counters, pending commands and recorded round trips.
+   */
+  void Reset() {
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    sent_ = matched_ = lost_ = 0;
+    pending_head_ = pending_size_ = 0;
+    window_next_ = window_size_ = 0;
+  }
+
+ private:
+  // Drop pending commands that waited longer than the timeout, they are ordered by send time
+  void ExpirePending(int64_t now) {
+    while (pending_size_ > 0 && now - pending_[pending_head_].sent_ns > options_.timeout_ns) {
+      pending_head_ = (pending_head_ + 1) % pending_.size();
+      pending_size_--;
+      lost_++;
+    }
+  }
+
+  // Remove the matched entry at offset and every older entry of the same part, keeping the others in order
+  void RemoveUpTo(BodyPartMask part, std::size_t offset) {
+    std::size_t kept = 0;
+    for (std::size_t ii = 0; ii < pending_size_; ii++) {
+      const Pending entry = pending_[(pending_head_ + ii) % pending_.size()];
+      if (entry.part == part && ii <= offset) {
+        if (ii < offset) {
+          lost_++;
+        }
+        continue;
+      }
+      pending_[(pending_head_ + kept) % pending_.size()] = entry;
+      kept++;
+    }
+    pending_size_ = kept;
+  }
+
+  const RoundTripProbeOptions options_;
+  const Matcher matcher_;
+
+  mutable gen1::detail::PriorityInheritanceMutex mutex_;
+  std::vector<Pending> pending_;  // Ring buffer of commands awaiting their echo, oldest first
+  std::size_t pending_head_ = 0;
+  std::size_t pending_size_ = 0;
+  std::vector<int64_t> window_;  // Ring buffer of the most recent round-trip latencies
+  std::size_t window_next_ = 0;
+  std::size_t window_size_ = 0;
+  uint64_t sent_ = 0;
+  uint64_t matched_ = 0;
+  uint64_t lost_ = 0;
+  bool echo_matched_ = false;  // Kept by Reset, tells a matcher that never fires from a lossy link
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "magic_type.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1 {
+
+/**
+ * @brief Message pool counters
+ */
+struct MessagePoolStats {
+  uint64_t hits = 0;          ///< Acquisitions served by a recycled message
+  uint64_t misses = 0;        ///< Acquisitions that had to allocate a new message
+  std::size_t capacity = 0;   ///< Maximum number of idle messages kept for reuse
+  std::size_t available = 0;  ///< Idle messages currently in the pool
+};
+
+/**
+ * @class MessagePool
+ * @brief Pool of recycled messages handed out as std::shared_ptr.
+ *
+ * Released messages go back to the pool through a custom deleter instead of being destroyed, so their inner vectors
+ * keep their capacity. The shared_ptr control blocks are preallocated and recycled as well, a hit performs no heap
+ * allocation, including the first capacity acquisitions.
+ * Messages may outlive the pool object, the pool storage is released with the last message.
+ *
+ * @tparam T Message type.
+ */
+template <typename T>
+class MessagePool final : public NonCopyable {
+  using Initializer = std::function<void(T&)>;
+
+  // Pool storage shared by the pool object and every message in flight
+  class Storage {
+   public:
+    Storage(std::size_t capacity, Initializer init)
+        : capacity_(capacity), init_(std::move(init)) {
+      messages_.reserve(capacity);
+      blocks_.reserve(capacity);
+      for (std::size_t ii = 0; ii < capacity; ii++) {
+        messages_.push_back(NewMessage());
+        blocks_.push_back(::operator new(kBlockSize));
+      }
+    }
+
+    ~Storage() {
+      for (T* message : messages_) {
+        delete message;
+      }
+      for (void* block : blocks_) {
+        ::operator delete(block);
+      }
+    }
+
+    T* TakeMessage(bool& hit) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!messages_.empty()) {
+          T* message = messages_.back();
+          messages_.pop_back();
+          hit = true;
+          return message;
+        }
+      }
+      hit = false;
+      return NewMessage();
+    }
+
+    void ReturnMessage(T* message) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (messages_.size() < capacity_) {
+          messages_.push_back(message);
+          return;
+        }
+      }
+      delete message;
+    }
+
+    void* TakeBlock(std::size_t size) {
+      if (size <= kBlockSize) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!blocks_.empty()) {
+          void* block = blocks_.back();
+          blocks_.pop_back();
+          return block;
+        }
+      }
+      return ::operator new(size <= kBlockSize ? kBlockSize : size);
+    }
+
+    void ReturnBlock(void* block, std::size_t size) {
+      if (size <= kBlockSize) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (blocks_.size() < capacity_) {
+          blocks_.push_back(block);
+          return;
+        }
+      }
+      ::operator delete(block);
+    }
+
+    std::size_t Available() const {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return messages_.size();
+    }
+
+    std::size_t Capacity() const { return capacity_; }
+
+   private:
+    static constexpr std::size_t kBlockSize = 128;  // Large enough for a shared_ptr control block with deleter and allocator
+
+    T* NewMessage() {
+      T* message = new T();
+      if (init_) {
+        init_(*message);
+      }
+      return message;
+    }
+
+    const std::size_t capacity_;
+    const Initializer init_;
+    mutable std::mutex mutex_;
+    std::vector<T*> messages_;
+    std::vector<void*> blocks_;
+  };
+
+  // Returns the message to the pool instead of deleting it
+  struct Recycler {
+    Storage* storage;
+    void operator()(T* message) const { storage->ReturnMessage(message); }
+  };
+
+  // Recycles the shared_ptr control block, keeps the storage alive until the block is released
+  template <typename U>
+  struct BlockAllocator {
+    using value_type = U;
+
+    explicit BlockAllocator(std::shared_ptr<Storage> s)
+        : storage(std::move(s)) {}
+    template <typename V>
+    BlockAllocator(const BlockAllocator<V>& other)
+        : storage(other.storage) {}
+
+    U* allocate(std::size_t n) { return static_cast<U*>(storage->TakeBlock(n * sizeof(U))); }
+    void deallocate(U* p, std::size_t n) { storage->ReturnBlock(p, n * sizeof(U)); }
+
+    template <typename V>
+    bool operator==(const BlockAllocator<V>& other) const { return storage == other.storage; }
+
+    std::shared_ptr<Storage> storage;
+  };
+
+ public:
+  /**
+   * @brief Constructor, preallocates all messages and their shared_ptr control blocks.
+   * @param capacity Number of messages allocated up front and kept for reuse.
+   * @param init Optional initializer applied once to every newly allocated message, e.g. to size its vectors.
+   */
+  explicit MessagePool(std::size_t capacity, Initializer init = nullptr)
+      : storage_(std::make_shared<Storage>(capacity, std::move(init))) {}
+
+  /**
+   * @brief Acquire a message, recycled when available.
+   * @return Message pointer, returned to the pool when the last copy is dropped. Recycled messages keep the content
+   *         of their previous use and must be fully overwritten by the caller.
+   */
+  std::shared_ptr<T> Acquire() {
+    bool hit = false;
+    T* message = storage_->TakeMessage(hit);
+    (hit ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return std::shared_ptr<T>(message, Recycler{storage_.get()}, BlockAllocator<T>(storage_));
+  }
+
+  /**
+   * @brief Get pool counters.
+   * @return Hit and miss counters accumulated since construction, plus current occupancy.
+   */
+  MessagePoolStats GetStats() const {
+    MessagePoolStats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.capacity = storage_->Capacity();
+    stats.available = storage_->Available();
+    return stats;
+  }
+
+ private:
+  std::shared_ptr<Storage> storage_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace magic::gen1
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
+#include "magic_executor.h"
 #include "magic_export.h"
 #include "magic_type.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace magic::gen1::motion {
 
@@ -16,6 +21,53 @@ using LowLevelMotionControllerPtr = std::unique_ptr<LowLevelMotionController>;
 class HighLevelMotionController;
 using HighLevelMotionControllerPtr = std::unique_ptr<HighLevelMotionController>;
 
+namespace detail {
+
+/**
+ * @brief Copy a fixed-capacity command into a per-thread staging command whose storage is reused across calls.
+ * @param command Fixed-capacity joint control command.
+ * @param timestamp Timestamp of the staging command (unit: nanoseconds).
+ * @return Staging command, valid until the next call on the same thread.
+ */
+template <typename Limb>
+const JointCommand& StageFixedCommand(const JointCommandT<Limb>& command, int64_t timestamp) {
+  thread_local JointCommand staging{0, std::vector<SingleJointCommand>(Limb::kJointNum)};
+  staging.timestamp = timestamp;
+  std::copy(command.joints.begin(), command.joints.end(), staging.joints.begin());
+  return staging;
+}
+
+/**
+ * @brief Copy a hand command into a per-thread staging command whose storage is reused across calls.
+ * @param command Hand control command.
+ * @param timestamp Timestamp of the staging command (unit: nanoseconds).
+ * @return Staging command, valid until the next call on the same thread.
+ */
+inline const HandCommand& StageHandCommand(const HandCommand& command, int64_t timestamp) {
+  thread_local HandCommand staging;
+  staging = command;  // reuses the capacity of the previous cycle
+  staging.timestamp = timestamp;
+  return staging;
+}
+
+/**
+ * @brief Copy a fixed-size hand command into a per-thread staging command whose storage is reused across calls.
+ * @param command Fixed-size hand control command.
+ * @param timestamp Timestamp of the staging command (unit: nanoseconds).
+ * @return Staging command, valid until the next call on the same thread.
+ */
+inline const HandCommand& StageHandCommand(const FixedHandCommand& command, int64_t timestamp) {
+  thread_local HandCommand staging{0, std::vector<SingleHandJointCommand>(kHandNum, SingleHandJointCommand{0, std::vector<double>(kHandJointNum)})};
+  staging.timestamp = timestamp;
+  for (std::size_t ii = 0; ii < kHandNum; ii++) {
+    staging.cmd[ii].operation_mode = command.hands[ii].operation_mode;
+    std::copy(command.hands[ii].pos.begin(), command.hands[ii].pos.end(), staging.cmd[ii].pos.begin());
+  }
+  return staging;
+}
+
+}  // namespace detail
+
 /**
  * @brief Abstract base class defining common interfaces for robot motion controllers.
  *
@@ -161,6 +213,15 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   void SubscribeArmState(ArmJointStateCallback callback);
 
+  /**
+   * @brief Subscribe to arm joint state data with dispatch options
+   * @param callback Callback function for processing received arm joint state data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeArmState(ArmJointStateCallback callback, const SubscriptionOptions& options) {
+    SubscribeArmState(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from arm joint state data
    */
@@ -173,6 +234,16 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   Status PublishArmCommand(const JointCommand& command);
 
+  /**
+   * @brief Publish arm joint control command from a fixed-capacity buffer
+   * @param command Arm joint control command holding exactly kArmJointNum joints
+   * @return Execution status.
+   * @note Does not allocate after the first call on each thread, intended for the real-time control loop.
+   */
+  Status PublishArmCommand(const ArmJointCommand& command) {
+    return PublishArmCommand(detail::StageFixedCommand(command, command.timestamp));
+  }
+
   // === Leg Control ===
 
   /**
@@ -181,6 +252,15 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   void SubscribeLegState(LegJointStateCallback callback);
 
+  /**
+   * @brief Subscribe to leg joint state data with dispatch options
+   * @param callback Callback function for processing received leg joint state data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeLegState(LegJointStateCallback callback, const SubscriptionOptions& options) {
+    SubscribeLegState(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from leg joint state data
    */
@@ -193,6 +273,16 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   Status PublishLegCommand(const JointCommand& command);
 
+  /**
+   * @brief Publish leg joint control command from a fixed-capacity buffer
+   * @param command Leg joint control command holding exactly kLegJointNum joints
+   * @return Execution status.
+   * @note Does not allocate after the first call on each thread, intended for the real-time control loop.
+   */
+  Status PublishLegCommand(const LegJointCommand& command) {
+    return PublishLegCommand(detail::StageFixedCommand(command, command.timestamp));
+  }
+
   // === Head Control ===
 
   /**
@@ -201,6 +291,15 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   void SubscribeHeadState(HeadJointStateCallback callback);
 
+  /**
+   * @brief Subscribe to head joint state data with dispatch options
+   * @param callback Callback function for processing received head joint state data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHeadState(HeadJointStateCallback callback, const SubscriptionOptions& options) {
+    SubscribeHeadState(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from head joint state data
    */
@@ -213,6 +312,16 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   Status PublishHeadCommand(const JointCommand& command);
 
+  /**
+   * @brief Publish head joint control command from a fixed-capacity buffer
+   * @param command Head joint control command holding exactly kHeadJointNum joints
+   * @return Execution status.
+   * @note Does not allocate after the first call on each thread, intended for the real-time control loop.
+   */
+  Status PublishHeadCommand(const HeadJointCommand& command) {
+    return PublishHeadCommand(detail::StageFixedCommand(command, command.timestamp));
+  }
+
   // === Waist Control ===
 
   /**
@@ -221,6 +330,15 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   void SubscribeWaistState(WaistJointStateCallback callback);
 
+  /**
+   * @brief Subscribe to waist joint state data with dispatch options
+   * @param callback Callback function for processing received waist joint state data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWaistState(WaistJointStateCallback callback, const SubscriptionOptions& options) {
+    SubscribeWaistState(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from waist joint state data
    */
@@ -233,6 +351,16 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   Status PublishWaistCommand(const JointCommand& command);
 
+  /**
+   * @brief Publish waist joint control command from a fixed-capacity buffer
+   * @param command Waist joint control command holding exactly kWaistJointNum joints
+   * @return Execution status.
+   * @note Does not allocate after the first call on each thread, intended for the real-time control loop.
+   */
+  Status PublishWaistCommand(const WaistJointCommand& command) {
+    return PublishWaistCommand(detail::StageFixedCommand(command, command.timestamp));
+  }
+
   // === Hand Control ===
 
   /**
@@ -241,6 +369,15 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   void SubscribeHandState(HandStateCallback callback);
 
+  /**
+   * @brief Subscribe to hand state data (such as gripping state, opening/closing degree, etc.) with dispatch options
+   * @param callback Callback function for processing received hand state data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHandState(HandStateCallback callback, const SubscriptionOptions& options) {
+    SubscribeHandState(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from hand state data
    */
@@ -253,16 +390,67 @@ class MAGIC_EXPORT_API LowLevelMotionController final : public MotionControllerB
    */
   Status PublishHandCommand(const HandCommand& command);
 
+  /**
+   * @brief Publish hand control command from a fixed-size buffer
+   * @param command Hand control command for both hands
+   * @return Execution status.
+   * @note Does not allocate after the first call on each thread.
+   */
+  Status PublishHandCommand(const FixedHandCommand& command) { return PublishHandCommand(detail::StageHandCommand(command, command.timestamp)); }
+
   /**
    * @brief Subscribe to body IMU data
    * @param callback Processing callback after receiving IMU data
    */
   void SubscribeBodyImu(const BodyImuCallback callback);
 
+  /**
+   * @brief Subscribe to body IMU data with dispatch options
+   * @param callback Processing callback after receiving IMU data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeBodyImu(BodyImuCallback callback, const SubscriptionOptions& options) {
+    SubscribeBodyImu(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from body IMU data
    */
   void UnsubscribeBodyImu();
+
+  // === Whole Body Control ===
+
+  /**
+   * @brief Publish control commands of several body parts for the same control cycle
+   * @param command Whole-body control command, only the parts selected by command.parts are published
+   * @return Execution status, the first failure is reported if any part fails.
+   * @note All parts are stamped with command.timestamp and sent back-to-back in the order leg, waist, arm, head, hand.
+   *       Every part is attempted even if an earlier one fails. Does not allocate after the first call on each thread.
+   */
+  Status PublishWholeBodyCommand(const WholeBodyCommand& command) {
+    Status result{ErrorCode::OK, ""};
+    auto merge = [&result](Status status, const char* part) {
+      if (status.code != ErrorCode::OK && result.code == ErrorCode::OK) {
+        result = {status.code, std::string(part) + ": " + status.message};
+      }
+    };
+    if (command.parts & kBodyPartLeg) {
+      merge(PublishLegCommand(detail::StageFixedCommand(command.leg, command.timestamp)), "leg");
+    }
+    if (command.parts & kBodyPartWaist) {
+      merge(PublishWaistCommand(detail::StageFixedCommand(command.waist, command.timestamp)), "waist");
+    }
+    if (command.parts & kBodyPartArm) {
+      merge(PublishArmCommand(detail::StageFixedCommand(command.arm, command.timestamp)), "arm");
+    }
+    if (command.parts & kBodyPartHead) {
+      merge(PublishHeadCommand(detail::StageFixedCommand(command.head, command.timestamp)), "head");
+    }
+    if (command.parts & kBodyPartHand) {
+      merge(PublishHandCommand(detail::StageHandCommand(command.hand, command.timestamp)), "hand");
+    }
+    return result;
+  }
 };
 
 }  // namespace magic::gen1::motion
\ No newline at end of file
@@ -0,0 +1,669 @@
+#pragma once
+
+#include "magic_blackbox.h"
+#include "magic_dynamics.h"
+#include "magic_histogram.h"
+#include "magic_joint_limiter.h"
+#include "magic_latency_probe.h"
+#include "magic_motion.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace magic::gen1::motion {
+
+template <typename Controller = LowLevelMotionController>
+class BasicLowLevelCommandPublisher;
+using LowLevelCommandPublisher = BasicLowLevelCommandPublisher<>;
+using LowLevelCommandPublisherPtr = std::unique_ptr<LowLevelCommandPublisher>;
+
+/**
+ * @brief Publish timing histogram configuration
+ *
+ * A range that is not positive leaves its histograms empty, every sample is then counted as invalid.
+ */
+struct PublishStatsOptions {
+  int64_t time_range_ns = 1000000;       ///< Range of the stage and send time histograms (unit: nanoseconds)
+  int64_t interval_range_ns = 10000000;  ///< Range of the inter-publish interval histogram (unit: nanoseconds)
+  std::size_t bins = 200;                ///< Number of bins per histogram
+};
+
+/**
+ * @brief Conflating publish configuration
+ */
+struct ConflationOptions {
+  uint8_t parts = kBodyPartArm | kBodyPartLeg | kBodyPartHead | kBodyPartWaist;  ///< Joint body parts sent through a mailbox, combination of BodyPartMask, hands are always sent directly
+  int priority = 0;                                                             ///< SCHED_FIFO priority [1, 99] of the send threads, 0 keeps the default scheduler
+  int cpu = -1;                                                                 ///< CPU core the send threads are pinned to, -1 means no pinning
+  std::string name = "magic_conflate";                                          ///< Send thread name, truncated to 15 characters
+};
+
+/**
+ * @brief Publish counters and timing distributions of one body part (unit: nanoseconds)
+ */
+struct PublishStats {
+  uint64_t published = 0;      ///< Commands sent to the core library
+  uint64_t failed = 0;         ///< Publish calls that returned a status other than OK
+  uint64_t conflated = 0;      ///< Commands replaced in the conflation mailbox by a newer one before they were sent
+  ErrorCode last_error = OK;   ///< Error code of the latest failed call
+  HistogramSnapshot stage;     ///< Feedforward, limiter and copy of a fixed-size command into the SDK message, empty for JointCommand input without stages
+  HistogramSnapshot send;      ///< Serialization and socket hand-off inside the core library
+  HistogramSnapshot interval;  ///< Time between consecutive publish calls
+};
+
+/**
+ * @brief Publish statistics of all body parts
+ */
+struct CommandPublishStats {
+  PublishStats arm;    ///< Upper limbs
+  PublishStats leg;    ///< Lower limbs
+  PublishStats head;   ///< Head
+  PublishStats waist;  ///< Waist
+  PublishStats hand;   ///< Hands
+};
+
+/**
+ * @class BasicLowLevelCommandPublisher
+ * @brief Instrumented publish path in front of LowLevelMotionController.
+ *
+ * Offers the same Publish*Command interfaces as the controller and records, per body part, how long the command
+ * staging and the core library send take, the interval between publishes and the number of failed sends.
+ * Recording does not allocate. Each body part is expected to be published from one thread.
+ *
+ * With conflation enabled, the joint commands of a body part are placed in a single-slot mailbox and sent by a
+ * dedicated thread. A command still waiting in the mailbox is replaced by the next one, so when the link stalls the
+ * stale setpoints are dropped instead of being sent late, and the publish call never waits for the core library.
+ *
+ * @tparam Controller LowLevelMotionController (LowLevelCommandPublisher), or LoopbackMotionController to run the
+ *         publish path without a robot.
+ */
+template <typename Controller>
+class BasicLowLevelCommandPublisher final : public NonCopyable {
+ public:
+  /**
+   * @brief Constructor.
+   * @param controller Low-level motion controller used to send the commands.
+   * @param options Histogram ranges.
+   */
+  explicit BasicLowLevelCommandPublisher(Controller& controller, const PublishStatsOptions& options = {})
+      : controller_(controller),
+        channels_{Channel(options), Channel(options), Channel(options), Channel(options), Channel(options)} {}
+
+  /// Destructor, stops the conflation send threads.
+  ~BasicLowLevelCommandPublisher() { DisableConflation(); }
+
+  // === Joint Commands ===
+
+  /**
+   * @brief Publish arm joint control command
+   * @param command Arm joint control command
+   * @return Execution status.
+   */
+  Status PublishArmCommand(const JointCommand& command) { return PublishVariable<ArmLimb>(kArm, command, [&] { return controller_.PublishArmCommand(command); }); }
+
+  /**
+   * @brief Publish arm joint control command from a fixed-capacity buffer
+   * @param command Arm joint control command holding exactly kArmJointNum joints
+   * @return Execution status.
+   */
+  Status PublishArmCommand(const ArmJointCommand& command) { return PublishFixed(kArm, command, command.timestamp); }
+
+  /**
+   * @brief Publish leg joint control command
+   * @param command Leg joint control command
+   * @return Execution status.
+   */
+  Status PublishLegCommand(const JointCommand& command) { return PublishVariable<LegLimb>(kLeg, command, [&] { return controller_.PublishLegCommand(command); }); }
+
+  /**
+   * @brief Publish leg joint control command from a fixed-capacity buffer
+   * @param command Leg joint control command holding exactly kLegJointNum joints
+   * @return Execution status.
+   */
+  Status PublishLegCommand(const LegJointCommand& command) { return PublishFixed(kLeg, command, command.timestamp); }
+
+  /**
+   * @brief Publish head joint control command
+   * @param command Head joint control command
+   * @return Execution status.
+   */
+  Status PublishHeadCommand(const JointCommand& command) { return PublishVariable<HeadLimb>(kHead, command, [&] { return controller_.PublishHeadCommand(command); }); }
+
+  /**
+   * @brief Publish head joint control command from a fixed-capacity buffer
+   * @param command Head joint control command holding exactly kHeadJointNum joints
+   * @return Execution status.
+   */
+  Status PublishHeadCommand(const HeadJointCommand& command) { return PublishFixed(kHead, command, command.timestamp); }
+
+  /**
+   * @brief Publish waist joint control command
+   * @param command Waist joint control command
+   * @return Execution status.
+   */
+  Status PublishWaistCommand(const JointCommand& command) { return PublishVariable<WaistLimb>(kWaist, command, [&] { return controller_.PublishWaistCommand(command); }); }
+
+  /**
+   * @brief Publish waist joint control command from a fixed-capacity buffer
+   * @param command Waist joint control command holding exactly kWaistJointNum joints
+   * @return Execution status.
+   */
+  Status PublishWaistCommand(const WaistJointCommand& command) { return PublishFixed(kWaist, command, command.timestamp); }
+
+  /**
+   * @brief Publish joint control command of a body part selected at runtime
+   * @param part Body part, one of kBodyPartArm, kBodyPartLeg, kBodyPartHead or kBodyPartWaist
+   * @param command Joint control command
+   * @return Execution status.
+   */
+  Status PublishJointCommand(BodyPartMask part, const JointCommand& command) {
+    switch (part) {
+      case kBodyPartArm:
+        return PublishArmCommand(command);
+      case kBodyPartLeg:
+        return PublishLegCommand(command);
+      case kBodyPartHead:
+        return PublishHeadCommand(command);
+      case kBodyPartWaist:
+        return PublishWaistCommand(command);
+      default:
+        return {ErrorCode::INTERNAL_ERROR, "not a joint body part"};
+    }
+  }
+
+  /**
+   * @brief Publish fixed-size joint control command of any body part
+   * @param command Joint control command, the body part is given by its limb
+   * @return Execution status.
+   */
+  template <typename Limb>
+  Status PublishJointCommand(const JointCommandT<Limb>& command) {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return PublishArmCommand(command);
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return PublishLegCommand(command);
+    } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+      return PublishHeadCommand(command);
+    } else {
+      static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb");
+      return PublishWaistCommand(command);
+    }
+  }
+
+  /**
+   * @brief Publish hand control command
+   * @param command Hand control command
+   * @return Execution status.
+   */
+  Status PublishHandCommand(const HandCommand& command) {
+    if (blackbox_) {
+      blackbox_->RecordHandCommand(command);
+    }
+    return Send(kHand, command.timestamp, 0, [&] { return controller_.PublishHandCommand(command); });
+  }
+
+  /**
+   * @brief Publish hand control command from a fixed-size buffer
+   * @param command Hand control command for both hands
+   * @return Execution status.
+   */
+  Status PublishHandCommand(const FixedHandCommand& command) { return PublishFixedHand(command, command.timestamp); }
+
+  /**
+   * @brief Publish control commands of several body parts for the same control cycle
+   * @param command Whole-body control command, only the parts selected by command.parts are published
+   * @return Execution status, the first failure is reported if any part fails.
+   * @note Same ordering and semantics as LowLevelMotionController::PublishWholeBodyCommand.
+   */
+  Status PublishWholeBodyCommand(const WholeBodyCommand& command) {
+    Status result{ErrorCode::OK, ""};
+    auto merge = [&result](Status status, const char* part) {
+      if (status.code != ErrorCode::OK && result.code == ErrorCode::OK) {
+        result = {status.code, std::string(part) + ": " + status.message};
+      }
+    };
+    if (command.parts & kBodyPartLeg) {
+      merge(PublishFixed(kLeg, command.leg, command.timestamp), "leg");
+    }
+    if (command.parts & kBodyPartWaist) {
+      merge(PublishFixed(kWaist, command.waist, command.timestamp), "waist");
+    }
+    if (command.parts & kBodyPartArm) {
+      merge(PublishFixed(kArm, command.arm, command.timestamp), "arm");
+    }
+    if (command.parts & kBodyPartHead) {
+      merge(PublishFixed(kHead, command.head, command.timestamp), "head");
+    }
+    if (command.parts & kBodyPartHand) {
+      merge(PublishFixedHand(command.hand, command.timestamp), "hand");
+    }
+    return result;
+  }
+
+  // === Statistics ===
+
+  /**
+   * @brief Get publish counters and timing histograms of all body parts.
+   * @return Statistics accumulated since construction or the last ResetPublishStats.
+   */
+  CommandPublishStats GetPublishStats() const {
+    CommandPublishStats stats;
+    stats.arm = channels_[kArm].Snapshot();
+    stats.leg = channels_[kLeg].Snapshot();
+    stats.head = channels_[kHead].Snapshot();
+    stats.waist = channels_[kWaist].Snapshot();
+    stats.hand = channels_[kHand].Snapshot();
+    return stats;
+  }
+
+  /**
+   * @brief Clear publish counters and timing histograms.
+   */
+  void ResetPublishStats() {
+    for (auto& channel : channels_) {
+      channel.Reset();
+    }
+  }
+
+  /**
+   * @brief Register every published joint command with a round-trip probe.
+   * @param probe Probe receiving the command timestamps, nullptr to detach.
+   * @note Must be called before publishing starts, it is not synchronized with the Publish*Command interfaces.
+   */
+  void SetRoundTripProbe(RoundTripProbePtr probe) { probe_ = std::move(probe); }
+
+  /**
+   * @brief Capture every joint and hand command in a blackbox, after the limiter and feedforward stages.
+   * @param blackbox Flight recorder, nullptr to detach.
+   * @note Must be called before publishing starts, it is not synchronized with the Publish*Command interfaces.
+   */
+  void SetBlackbox(monitor::BlackboxPtr blackbox) { blackbox_ = std::move(blackbox); }
+
+  // === Conflation ===
+
+  /**
+   * @brief Send the joint commands of the selected body parts from a latest-value mailbox on their own threads.
+   *
+   * Publish*Command then returns OK once the command is in the mailbox, send failures are only reported through
+   * GetPublishStats. Command stages and the round-trip probe run on the send thread, on the command actually sent.
+   * Parts published together with PublishWholeBodyCommand are no longer sent in a fixed order.
+   *
+   * @param options Body parts, send thread priority and CPU affinity.
+   * @return Execution status, fails if conflation is already enabled or a send thread cannot be created.
+   * @note Must be called before publishing starts, it is not synchronized with the Publish*Command interfaces.
+   *       With conflation enabled, JointCommand input of the wrong joint count is rejected.
+   */
+  Status EnableConflation(const ConflationOptions& options = {}) {
+    if (arm_mailbox_ || leg_mailbox_ || head_mailbox_ || waist_mailbox_) {
+      return {ErrorCode::SERVICE_ERROR, "conflation already enabled"};
+    }
+    int ret = 0;
+    if (ret == 0 && (options.parts & kBodyPartArm)) {
+      ret = StartMailbox<ArmLimb>(kArm, options);
+    }
+    if (ret == 0 && (options.parts & kBodyPartLeg)) {
+      ret = StartMailbox<LegLimb>(kLeg, options);
+    }
+    if (ret == 0 && (options.parts & kBodyPartHead)) {
+      ret = StartMailbox<HeadLimb>(kHead, options);
+    }
+    if (ret == 0 && (options.parts & kBodyPartWaist)) {
+      ret = StartMailbox<WaistLimb>(kWaist, options);
+    }
+    if (ret != 0) {
+      DisableConflation();
+      return {ErrorCode::INTERNAL_ERROR, std::string("failed to create send thread: ") + std::strerror(ret)};
+    }
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Stop the conflation send threads and publish directly again, commands still in a mailbox are discarded.
+   * @note Must not be called while publishing, it is not synchronized with the Publish*Command interfaces.
+   */
+  void DisableConflation() {
+    StopMailbox<ArmLimb>();
+    StopMailbox<LegLimb>();
+    StopMailbox<HeadLimb>();
+    StopMailbox<WaistLimb>();
+  }
+
+  // === Command Stages ===
+
+  /**
+   * @brief Run every joint command of one body part through a limiter before it is published.
+   * @param limiter Limiter of the body part, nullptr to detach. Its time is recorded as stage time.
+   * @note Must be called before publishing starts, it is not synchronized with the Publish*Command interfaces.
+   *       With a limiter attached, JointCommand input of the wrong joint count is rejected.
+   */
+  template <typename Limb>
+  void SetLimiter(JointLimiterPtr<Limb> limiter) { Limiter<Limb>() = std::move(limiter); }
+
+  /**
+   * @brief Add model-based torque feedforward to every joint command of one body part before it is published.
+   * @param feedforward Feedforward of the arms, legs or head, nullptr to detach. It runs before the limiter, so torque
+   *        limits apply to the total torque. Its time is recorded as stage time.
+   * @note Must be called before publishing starts, it is not synchronized with the Publish*Command interfaces.
+   *       With a feedforward attached, JointCommand input of the wrong joint count is rejected.
+   */
+  template <typename Limb>
+  void SetFeedforward(kinematics::TorqueFeedforwardPtr<Limb> feedforward) { Feedforward<Limb>() = std::move(feedforward); }
+
+ private:
+  enum Part : std::size_t { kArm = 0, kLeg, kHead, kWaist, kHand, kPartNum };
+
+  static constexpr BodyPartMask kPartMasks[kPartNum] = {kBodyPartArm, kBodyPartLeg, kBodyPartHead, kBodyPartWaist, kBodyPartHand};
+
+  // Statistics of one body part
+  struct Channel {
+    explicit Channel(const PublishStatsOptions& options)
+        : stage(0.0, static_cast<double>(options.time_range_ns), options.bins),
+          send(0.0, static_cast<double>(options.time_range_ns), options.bins),
+          interval(0.0, static_cast<double>(options.interval_range_ns), options.bins) {}
+
+    PublishStats Snapshot() const {
+      PublishStats stats;
+      stats.published = published.load(std::memory_order_relaxed);
+      stats.failed = failed.load(std::memory_order_relaxed);
+      stats.conflated = conflated.load(std::memory_order_relaxed);
+      stats.last_error = last_error.load(std::memory_order_relaxed);
+      stats.stage = stage.Snapshot();
+      stats.send = send.Snapshot();
+      stats.interval = interval.Snapshot();
+      return stats;
+    }
+
+    void Reset() {
+      published.store(0, std::memory_order_relaxed);
+      failed.store(0, std::memory_order_relaxed);
+      conflated.store(0, std::memory_order_relaxed);
+      last_error.store(OK, std::memory_order_relaxed);
+      last_publish_ns.store(0, std::memory_order_relaxed);
+      stage.Reset();
+      send.Reset();
+      interval.Reset();
+    }
+
+    Histogram stage;
+    Histogram send;
+    Histogram interval;
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> conflated{0};
+    std::atomic<ErrorCode> last_error{OK};
+    std::atomic<int64_t> last_publish_ns{0};  // Written by the sending thread and by ResetPublishStats
+  };
+
+  // Single-slot mailbox and send thread of one body part. The lock inherits the priority of a real-time publisher, so a
+  // send thread on the default scheduler cannot stall it while copying the command out
+  template <typename Limb>
+  struct Mailbox {
+    BasicLowLevelCommandPublisher* owner = nullptr;
+    Part part = kArm;
+    pthread_t thread{};
+    gen1::detail::PriorityInheritanceMutex mutex;
+    std::condition_variable_any cv;
+    bool running = true;
+    bool full = false;
+    int64_t timestamp = 0;
+    JointCommandT<Limb> command;
+  };
+
+  template <typename Limb>
+  using MailboxPtr = std::unique_ptr<Mailbox<Limb>>;
+
+  template <typename Limb>
+  MailboxPtr<Limb>& MailboxOf() {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return arm_mailbox_;
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return leg_mailbox_;
+    } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+      return head_mailbox_;
+    } else {
+      static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb");
+      return waist_mailbox_;
+    }
+  }
+
+  template <typename Limb>
+  int StartMailbox(Part part, const ConflationOptions& options) {
+    auto mailbox = std::make_unique<Mailbox<Limb>>();
+    mailbox->owner = this;
+    mailbox->part = part;
+    int ret = gen1::detail::CreateThread(mailbox->thread, &BasicLowLevelCommandPublisher::MailboxEntry<Limb>, mailbox.get(), options.priority, options.cpu, options.name);
+    if (ret == 0) {
+      MailboxOf<Limb>() = std::move(mailbox);
+    }
+    return ret;
+  }
+
+  template <typename Limb>
+  void StopMailbox() {
+    auto& mailbox = MailboxOf<Limb>();
+    if (!mailbox) {
+      return;
+    }
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mailbox->mutex);
+      mailbox->running = false;
+    }
+    mailbox->cv.notify_one();
+    pthread_join(mailbox->thread, nullptr);
+    mailbox.reset();
+  }
+
+  template <typename Limb>
+  static void* MailboxEntry(void* arg) {
+    auto* mailbox = static_cast<Mailbox<Limb>*>(arg);
+    mailbox->owner->DrainMailbox(*mailbox);
+    return nullptr;
+  }
+
+  template <typename Limb>
+  void DrainMailbox(Mailbox<Limb>& mailbox) {
+    JointCommandT<Limb> command;
+    while (true) {
+      int64_t timestamp = 0;
+      {
+        std::unique_lock<gen1::detail::PriorityInheritanceMutex> lock(mailbox.mutex);
+        mailbox.cv.wait(lock, [&mailbox] { return mailbox.full || !mailbox.running; });
+        if (!mailbox.running) {
+          return;
+        }
+        command = mailbox.command;
+        timestamp = mailbox.timestamp;
+        mailbox.full = false;
+      }
+      SendFixed(mailbox.part, command, timestamp);
+    }
+  }
+
+  // Replace any unsent command of the body part, the send thread picks up the latest one
+  template <typename Limb>
+  Status Post(Mailbox<Limb>& mailbox, const JointCommandT<Limb>& command, int64_t timestamp) {
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mailbox.mutex);
+      if (mailbox.full) {
+        channels_[mailbox.part].conflated.fetch_add(1, std::memory_order_relaxed);
+      }
+      mailbox.command = command;
+      mailbox.timestamp = timestamp;
+      mailbox.full = true;
+    }
+    mailbox.cv.notify_one();
+    return {ErrorCode::OK, ""};
+  }
+
+  template <typename Limb>
+  JointLimiterPtr<Limb>& Limiter() {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return arm_limiter_;
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return leg_limiter_;
+    } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+      return head_limiter_;
+    } else {
+      static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb");
+      return waist_limiter_;
+    }
+  }
+
+  template <typename Limb>
+  kinematics::TorqueFeedforwardPtr<Limb>& Feedforward() {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return arm_feedforward_;
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return leg_feedforward_;
+    } else {
+      static_assert(std::is_same_v<Limb, HeadLimb>, "unsupported limb");
+      return head_feedforward_;
+    }
+  }
+
+  // Whether any stage modifies the commands of the body part
+  template <typename Limb>
+  bool HasStage() {
+    if constexpr (std::is_same_v<Limb, WaistLimb>) {
+      return static_cast<bool>(Limiter<Limb>());
+    } else {
+      return Limiter<Limb>() || Feedforward<Limb>();
+    }
+  }
+
+  // Variable-size input goes through the fixed-size path when a stage or a mailbox is attached
+  template <typename Limb, typename SendFunction>
+  Status PublishVariable(Part part, const JointCommand& command, SendFunction&& send) {
+    if (!HasStage<Limb>() && !MailboxOf<Limb>()) {
+      if (blackbox_) {
+        blackbox_->RecordCommand<Limb>(command);
+      }
+      return Send(part, command.timestamp, 0, send);
+    }
+    if (command.joints.size() != Limb::kJointNum) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid joint count"};
+    }
+    JointCommandT<Limb> fixed;
+    std::copy_n(command.joints.begin(), Limb::kJointNum, fixed.joints.begin());
+    return PublishFixed(part, fixed, command.timestamp);
+  }
+
+  template <typename Limb>
+  Status PublishFixed(Part part, const JointCommandT<Limb>& command, int64_t timestamp) {
+    if (const auto& mailbox = MailboxOf<Limb>()) {
+      return Post(*mailbox, command, timestamp);
+    }
+    return SendFixed(part, command, timestamp);
+  }
+
+  template <typename Limb>
+  Status SendFixed(Part part, const JointCommandT<Limb>& command, int64_t timestamp) {
+    int64_t begin = detail::SteadyNowNs();
+    const JointCommandT<Limb>* source = &command;
+    JointCommandT<Limb> modified;
+    if (HasStage<Limb>()) {
+      modified = command;
+      if constexpr (!std::is_same_v<Limb, WaistLimb>) {
+        if (const auto& feedforward = Feedforward<Limb>()) {
+          feedforward->Apply(modified);
+        }
+      }
+      if (const auto& limiter = Limiter<Limb>()) {
+        limiter->Apply(modified);
+      }
+      source = &modified;
+    }
+    if (blackbox_) {
+      blackbox_->RecordCommand(*source, timestamp);
+    }
+    const JointCommand& staged = detail::StageFixedCommand(*source, timestamp);
+    int64_t stage_ns = detail::SteadyNowNs() - begin;
+    return Send(part, timestamp, stage_ns, [&] {
+      switch (part) {
+        case kArm:
+          return controller_.PublishArmCommand(staged);
+        case kLeg:
+          return controller_.PublishLegCommand(staged);
+        case kHead:
+          return controller_.PublishHeadCommand(staged);
+        default:
+          return controller_.PublishWaistCommand(staged);
+      }
+    });
+  }
+
+  Status PublishFixedHand(const FixedHandCommand& command, int64_t timestamp) {
+    int64_t begin = detail::SteadyNowNs();
+    if (blackbox_) {
+      blackbox_->RecordHandCommand(command, timestamp);
+    }
+    const HandCommand& staged = detail::StageHandCommand(command, timestamp);
+    return Send(kHand, timestamp, detail::SteadyNowNs() - begin, [&] { return controller_.PublishHandCommand(staged); });
+  }
+
+  /**
+   * @brief Run one core library publish call and record its statistics.
+   * @param part Body part.
+   * @param timestamp Command timestamp, registered with the round-trip probe.
+   * @param stage_ns Time spent staging the command, 0 if the command was passed through.
+   * @param send Publish call.
+   */
+  template <typename SendFunction>
+  Status Send(Part part, int64_t timestamp, int64_t stage_ns, SendFunction&& send) {
+    Channel& channel = channels_[part];
+    if (probe_ && part != kHand) {
+      probe_->OnCommandSent(kPartMasks[part], timestamp);
+    }
+    int64_t begin = detail::SteadyNowNs();
+    Status status = send();
+    int64_t end = detail::SteadyNowNs();
+
+    if (stage_ns > 0) {
+      channel.stage.Record(static_cast<double>(stage_ns));
+    }
+    channel.send.Record(static_cast<double>(end - begin));
+    int64_t last_publish_ns = channel.last_publish_ns.exchange(begin, std::memory_order_relaxed);
+    if (last_publish_ns != 0) {
+      channel.interval.Record(static_cast<double>(begin - last_publish_ns));
+    }
+    channel.published.fetch_add(1, std::memory_order_relaxed);
+    if (status.code != ErrorCode::OK) {
+      channel.failed.fetch_add(1, std::memory_order_relaxed);
+      channel.last_error.store(status.code, std::memory_order_relaxed);
+    }
+    return status;
+  }
+
+  Controller& controller_;
+  std::array<Channel, kPartNum> channels_;
+  RoundTripProbePtr probe_;
+  monitor::BlackboxPtr blackbox_;
+  JointLimiterPtr<ArmLimb> arm_limiter_;
+  JointLimiterPtr<LegLimb> leg_limiter_;
+  JointLimiterPtr<HeadLimb> head_limiter_;
+  JointLimiterPtr<WaistLimb> waist_limiter_;
+  kinematics::TorqueFeedforwardPtr<ArmLimb> arm_feedforward_;
+  kinematics::TorqueFeedforwardPtr<LegLimb> leg_feedforward_;
+  kinematics::TorqueFeedforwardPtr<HeadLimb> head_feedforward_;
+  MailboxPtr<ArmLimb> arm_mailbox_;
+  MailboxPtr<LegLimb> leg_mailbox_;
+  MailboxPtr<HeadLimb> head_mailbox_;
+  MailboxPtr<WaistLimb> waist_mailbox_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
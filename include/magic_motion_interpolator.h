@@ -0,0 +1,269 @@
+#pragma once
+
+#include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+class CommandInterpolator;
+using CommandInterpolatorPtr = std::unique_ptr<CommandInterpolator>;
+
+/**
+ * @brief Interpolation between consecutive keyframes
+ */
+enum class InterpolationMode : int8_t {
+  LINEAR = 0,         ///< Linear position, constant velocity over each segment
+  CUBIC_HERMITE = 1,  ///< Cubic Hermite spline through the keyframe positions and velocities
+};
+
+namespace detail {
+
+/**
+ * @brief Interpolate one joint between two keyframes.
+ * @param mode Interpolation mode.
+ * @param from Keyframe at the start of the segment.
+ * @param to Keyframe at the end of the segment.
+ * @param duration_s Segment duration (unit: seconds), must be positive.
+ * @param s Normalized time in the segment, [0, 1].
+ * @param[out] out Interpolated command, operation mode taken from the start keyframe.
+ */
+inline void InterpolateJoint(InterpolationMode mode, const SingleJointCommand& from, const SingleJointCommand& to, double duration_s, double s, SingleJointCommand& out) {
+  out.operation_mode = from.operation_mode;
+  if (mode == InterpolationMode::LINEAR) {
+    out.pos = from.pos + (to.pos - from.pos) * s;
+    out.vel = (to.pos - from.pos) / duration_s;
+  } else {
+    double s2 = s * s;
+    double s3 = s2 * s;
+    out.pos = (2 * s3 - 3 * s2 + 1) * from.pos + (s3 - 2 * s2 + s) * duration_s * from.vel + (-2 * s3 + 3 * s2) * to.pos + (s3 - s2) * duration_s * to.vel;
+    out.vel = (6 * s2 - 6 * s) * (from.pos - to.pos) / duration_s + (3 * s2 - 4 * s + 1) * from.vel + (3 * s2 - 2 * s) * to.vel;
+  }
+  out.toq = from.toq + (to.toq - from.toq) * s;
+  out.kp = from.kp + (to.kp - from.kp) * s;
+  out.kd = from.kd + (to.kd - from.kd) * s;
+}
+
+/**
+ * @brief Number of joints of a single body part.
+ * @param part Body part, one of kBodyPartArm, kBodyPartLeg, kBodyPartHead or kBodyPartWaist.
+ * @return Joint count, 0 for any other value.
+ */
+inline std::size_t JointCount(BodyPartMask part) {
+  switch (part) {
+    case kBodyPartArm:
+      return kArmJointNum;
+    case kBodyPartLeg:
+      return kLegJointNum;
+    case kBodyPartHead:
+      return kHeadJointNum;
+    case kBodyPartWaist:
+      return kWaistJointNum;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Command interpolator configuration
+ */
+struct CommandInterpolatorOptions {
+  BodyPartMask part = kBodyPartArm;                           ///< Body part driven by the interpolator, one of arm, leg, head or waist
+  InterpolationMode mode = InterpolationMode::CUBIC_HERMITE;  ///< Interpolation between keyframes
+  std::size_t max_keyframes = 64;                             ///< Keyframes buffered ahead of the current segment
+  RtControlLoopOptions loop;                                  ///< Publish loop, its period is the output rate (default 500Hz)
+};
+
+/**
+ * @brief Command interpolator counters
+ */
+struct CommandInterpolatorStats {
+  uint64_t submitted = 0;  ///< Keyframes accepted
+  uint64_t rejected = 0;   ///< Keyframes rejected (wrong joint count, not increasing in time, buffer full)
+  uint64_t published = 0;  ///< Interpolated commands published
+  uint64_t failed = 0;     ///< Publish calls that returned a status other than OK
+  uint64_t starved = 0;    ///< Cycles past the last keyframe, the last keyframe was held
+};
+
+/**
+ * @class CommandInterpolator
+ * @brief Upsamples sparse joint command keyframes to the servo rate on a real-time thread.
+ *
+ * The application submits timestamped keyframes at its planning rate (e.g. 50-100Hz). Keyframe timestamps are the
+ * times at which the keyframe should be reached, on CLOCK_MONOTONIC (see NowNs). Every loop period the interpolator
+ * evaluates the segment containing the current time, linearly or as a cubic Hermite spline on position and velocity,
+ * and publishes the result through the command publisher, so its limiter, feedforward, statistics, probe and
+ * blackbox apply. Nothing is published before the first keyframe is due; after the last keyframe its position is held
+ * with zero velocity until new keyframes arrive. The keyframe buffer is guarded by a priority-inheriting mutex and the
+ * counters are atomic, so application threads never stall the publish loop.
+ */
+class CommandInterpolator final : public NonCopyable {
+ public:
+  /**
+   * @brief Constructor.
+   * @param publisher Command publisher used to publish the interpolated commands.
+   * @param options Interpolator configuration.
+   */
+  explicit CommandInterpolator(LowLevelCommandPublisher& publisher, const CommandInterpolatorOptions& options = {})
+      : publisher_(publisher),
+        options_(options),
+        joint_num_(detail::JointCount(options.part)),
+        keyframes_(std::max<std::size_t>(options.max_keyframes, 1) + 1),
+        output_{0, std::vector<SingleJointCommand>(joint_num_)},
+        loop_(options.loop) {
+    for (auto& keyframe : keyframes_) {
+      keyframe.joints.reserve(joint_num_);
+    }
+  }
+
+  /// Destructor, stops the publish loop.
+  ~CommandInterpolator() { Stop(); }
+
+  /**
+   * @brief Current time on the keyframe clock.
+   * @return CLOCK_MONOTONIC time (unit: nanoseconds).
+   */
+  static int64_t NowNs() { return detail::SteadyNowNs(); }
+
+  /**
+   * @brief Start the publish loop.
+   * @return Execution status, fails for an unsupported body part or if the real-time thread cannot be created.
+   */
+  Status Start() {
+    if (joint_num_ == 0) {
+      return {ErrorCode::INTERNAL_ERROR, "interpolator body part must be arm, leg, head or waist"};
+    }
+    return loop_.Start([this](const RtCycleInfo& info) { Step(info.wakeup_ns); });
+  }
+
+  /**
+   * @brief Stop the publish loop, buffered keyframes are kept.
+   */
+  void Stop() { loop_.Stop(); }
+
+  /**
+   * @brief Queue a keyframe.
+   * @param keyframe Joint command to reach at keyframe.timestamp, must be later than the previously submitted one.
+   * @return Execution status.
+   */
+  Status SubmitKeyframe(const JointCommand& keyframe) {
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    if (keyframe.joints.size() != joint_num_) {
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return {ErrorCode::INTERNAL_ERROR, "invalid joint count"};
+    }
+    if (size_ > 0 && keyframe.timestamp <= At(size_ - 1).timestamp) {
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return {ErrorCode::INTERNAL_ERROR, "keyframe timestamp not increasing"};
+    }
+    if (size_ == keyframes_.size()) {
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return {ErrorCode::SERVICE_ERROR, "keyframe buffer full"};
+    }
+    JointCommand& slot = At(size_);
+    slot.timestamp = keyframe.timestamp;
+    slot.joints.assign(keyframe.joints.begin(), keyframe.joints.end());  // reuses the reserved capacity
+    size_++;
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Drop all buffered keyframes, publishing stops until a new keyframe is due.
+   */
+  void ClearKeyframes() {
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    head_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * @brief Get interpolator counters.
+   * @return Counters accumulated since construction.
+   */
+  CommandInterpolatorStats GetStats() const {
+    CommandInterpolatorStats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.starved = starved_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  /**
+   * @brief Get the timing statistics of the publish loop.
+   * @return Loop period, jitter and step time histograms.
+   */
+  RtControlLoopStats GetLoopStats() const { return loop_.GetStats(); }
+
+ private:
+  JointCommand& At(std::size_t index) { return keyframes_[(head_ + index) % keyframes_.size()]; }
+
+  // One publish cycle on the loop thread
+  void Step(int64_t now) {
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+      if (size_ == 0 || now < At(0).timestamp) {
+        return;
+      }
+      // Keep only the last keyframe at or before now as the segment start
+      while (size_ > 1 && At(1).timestamp <= now) {
+        head_ = (head_ + 1) % keyframes_.size();
+        size_--;
+      }
+      const JointCommand& from = At(0);
+      if (size_ == 1) {
+        for (std::size_t ii = 0; ii < joint_num_; ii++) {
+          output_.joints[ii] = from.joints[ii];
+          output_.joints[ii].vel = 0.0;
+        }
+        starved_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        const JointCommand& to = At(1);
+        double duration_s = static_cast<double>(to.timestamp - from.timestamp) * 1e-9;
+        double s = static_cast<double>(now - from.timestamp) / static_cast<double>(to.timestamp - from.timestamp);
+        for (std::size_t ii = 0; ii < joint_num_; ii++) {
+          detail::InterpolateJoint(options_.mode, from.joints[ii], to.joints[ii], duration_s, s, output_.joints[ii]);
+        }
+      }
+    }
+    output_.timestamp = now;
+    Status status = publisher_.PublishJointCommand(options_.part, output_);
+    published_.fetch_add(1, std::memory_order_relaxed);
+    if (status.code != ErrorCode::OK) {
+      failed_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  LowLevelCommandPublisher& publisher_;
+  const CommandInterpolatorOptions options_;
+  const std::size_t joint_num_;
+
+  gen1::detail::PriorityInheritanceMutex mutex_;  // Guards the keyframe buffer
+  std::vector<JointCommand> keyframes_;           // Ring buffer, the first entry is the start of the current segment
+  std::size_t head_ = 0;
+  std::size_t size_ = 0;
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<uint64_t> rejected_{0};
+  std::atomic<uint64_t> published_{0};
+  std::atomic<uint64_t> failed_{0};
+  std::atomic<uint64_t> starved_{0};
+
+  JointCommand output_;  // Touched only by the loop thread
+  RtControlLoop loop_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
@@ -0,0 +1,351 @@
+#pragma once
+
+#include "magic_message_pool.h"
+#include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_state.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+class LoopbackMotionController;
+using LoopbackMotionControllerPtr = std::unique_ptr<LoopbackMotionController>;
+using LoopbackStateHub = BasicLowLevelStateHub<LoopbackMotionController>;                    // State hub on the loopback
+using LoopbackCommandPublisher = BasicLowLevelCommandPublisher<LoopbackMotionController>;  // Command publisher on the loopback
+
+/**
+ * @brief Loopback controller configuration
+ */
+struct LoopbackOptions {
+  int64_t latency_ns = 0;         ///< Delay between a command and its echoed state (unit: nanoseconds)
+  std::size_t queue_depth = 64;   ///< Commands awaiting their echo, the oldest one is dropped when full
+  std::size_t pool_capacity = 8;  ///< Recycled state messages per body part
+};
+
+/**
+ * @class LoopbackMotionController
+ * @brief Local stand-in for the joint command and state path of LowLevelMotionController.
+ *
+ * Every published joint command is turned into a joint state of the same body part after the configured latency and
+ * delivered on the loopback thread. The state carries the command timestamp and reports the commanded position,
+ * velocity and torque as measured values. It offers the controller interfaces used by the SDK-side pipeline, so
+ * LoopbackCommandPublisher and LoopbackStateHub run the same publisher, state hub and round-trip probe code as on the
+ * robot, without a robot; no command leaves the process. Hand commands are accepted but not echoed, and no hand or
+ * body IMU state is produced.
+ */
+class LoopbackMotionController final : public NonCopyable {
+  using JointStatePtr = std::shared_ptr<JointState>;                    // Joint state message pointer
+  using JointStateCallback = std::function<void(const JointStatePtr)>;  // Joint state callback function type
+
+  enum Part : std::size_t { kArm = 0, kLeg, kHead, kWaist, kPartNum };
+
+  struct Entry {
+    Part part = kArm;
+    int64_t due_ns = 0;
+    JointCommand command{0, {}};
+  };
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param options Loopback configuration.
+   */
+  explicit LoopbackMotionController(const LoopbackOptions& options = {})
+      : options_(options),
+        entries_(std::max<std::size_t>(options.queue_depth, 1)),
+        pools_{MessagePool<JointState>(options.pool_capacity, InitState(kArmJointNum)),
+               MessagePool<JointState>(options.pool_capacity, InitState(kLegJointNum)),
+               MessagePool<JointState>(options.pool_capacity, InitState(kHeadJointNum)),
+               MessagePool<JointState>(options.pool_capacity, InitState(kWaistJointNum))} {
+    for (auto& entry : entries_) {
+      entry.command.joints.reserve(kArmJointNum);
+    }
+  }
+
+  /// Destructor, stops the loopback thread.
+  ~LoopbackMotionController() { Shutdown(); }
+
+  /**
+   * @brief Start the loopback thread.
+   * @return Whether initialization was successful.
+   */
+  bool Initialize() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (!is_shutdown_.load()) {
+      return true;
+    }
+    is_shutdown_.store(false);
+    thread_ = std::thread(&LoopbackMotionController::Run, this);
+    return true;
+  }
+
+  /**
+   * @brief Stop the loopback thread, pending echoes are discarded.
+   */
+  void Shutdown() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    {
+      std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+      if (is_shutdown_.exchange(true)) {
+        return;
+      }
+      head_ = 0;
+      size_ = 0;
+    }
+    queue_cv_.notify_all();
+    thread_.join();
+  }
+
+  // === Joint Commands ===
+
+  /**
+   * @brief Publish arm joint control command
+   * @param command Arm joint control command
+   * @return Execution status.
+   */
+  Status PublishArmCommand(const JointCommand& command) { return Enqueue(kArm, kArmJointNum, command); }
+
+  /**
+   * @brief Publish arm joint control command from a fixed-capacity buffer
+   * @param command Arm joint control command
+   * @return Execution status.
+   */
+  Status PublishArmCommand(const ArmJointCommand& command) { return PublishArmCommand(detail::StageFixedCommand(command, command.timestamp)); }
+
+  /**
+   * @brief Publish leg joint control command
+   * @param command Leg joint control command
+   * @return Execution status.
+   */
+  Status PublishLegCommand(const JointCommand& command) { return Enqueue(kLeg, kLegJointNum, command); }
+
+  /**
+   * @brief Publish leg joint control command from a fixed-capacity buffer
+   * @param command Leg joint control command
+   * @return Execution status.
+   */
+  Status PublishLegCommand(const LegJointCommand& command) { return PublishLegCommand(detail::StageFixedCommand(command, command.timestamp)); }
+
+  /**
+   * @brief Publish head joint control command
+   * @param command Head joint control command
+   * @return Execution status.
+   */
+  Status PublishHeadCommand(const JointCommand& command) { return Enqueue(kHead, kHeadJointNum, command); }
+
+  /**
+   * @brief Publish head joint control command from a fixed-capacity buffer
+   * @param command Head joint control command
+   * @return Execution status.
+   */
+  Status PublishHeadCommand(const HeadJointCommand& command) { return PublishHeadCommand(detail::StageFixedCommand(command, command.timestamp)); }
+
+  /**
+   * @brief Publish waist joint control command
+   * @param command Waist joint control command
+   * @return Execution status.
+   */
+  Status PublishWaistCommand(const JointCommand& command) { return Enqueue(kWaist, kWaistJointNum, command); }
+
+  /**
+   * @brief Publish waist joint control command from a fixed-capacity buffer
+   * @param command Waist joint control command
+   * @return Execution status.
+   */
+  Status PublishWaistCommand(const WaistJointCommand& command) { return PublishWaistCommand(detail::StageFixedCommand(command, command.timestamp)); }
+
+  /**
+   * @brief Publish hand control command, accepted without an echo
+   * @param command Hand control command
+   * @return Execution status.
+   */
+  Status PublishHandCommand(const HandCommand& command) {
+    (void)command;
+    return is_shutdown_.load() ? Status{ErrorCode::SERVICE_NOT_READY, "loopback not initialized"} : Status{ErrorCode::OK, ""};
+  }
+
+  // === Joint States ===
+
+  /**
+   * @brief Subscribe to echoed arm joint states
+   * @param callback Called on the loopback thread for every echoed state
+   */
+  void SubscribeArmState(JointStateCallback callback) { SetCallback(kArm, std::move(callback)); }
+
+  /**
+   * @brief Unsubscribe from echoed arm joint states
+   */
+  void UnsubscribeArmState() { SetCallback(kArm, nullptr); }
+
+  /**
+   * @brief Subscribe to echoed leg joint states
+   * @param callback Called on the loopback thread for every echoed state
+   */
+  void SubscribeLegState(JointStateCallback callback) { SetCallback(kLeg, std::move(callback)); }
+
+  /**
+   * @brief Unsubscribe from echoed leg joint states
+   */
+  void UnsubscribeLegState() { SetCallback(kLeg, nullptr); }
+
+  /**
+   * @brief Subscribe to echoed head joint states
+   * @param callback Called on the loopback thread for every echoed state
+   */
+  void SubscribeHeadState(JointStateCallback callback) { SetCallback(kHead, std::move(callback)); }
+
+  /**
+   * @brief Unsubscribe from echoed head joint states
+   */
+  void UnsubscribeHeadState() { SetCallback(kHead, nullptr); }
+
+  /**
+   * @brief Subscribe to echoed waist joint states
+   * @param callback Called on the loopback thread for every echoed state
+   */
+  void SubscribeWaistState(JointStateCallback callback) { SetCallback(kWaist, std::move(callback)); }
+
+  /**
+   * @brief Unsubscribe from echoed waist joint states
+   */
+  void UnsubscribeWaistState() { SetCallback(kWaist, nullptr); }
+
+  /**
+   * @brief Subscribe to hand states, none are produced by the loopback
+   * @param callback Never called
+   */
+  void SubscribeHandState(std::function<void(const std::shared_ptr<HandState>)> callback) { (void)callback; }
+
+  /**
+   * @brief Unsubscribe from hand states
+   */
+  void UnsubscribeHandState() {}
+
+  /**
+   * @brief Subscribe to body IMU data, none is produced by the loopback
+   * @param callback Never called
+   */
+  void SubscribeBodyImu(std::function<void(const std::shared_ptr<Imu>)> callback) { (void)callback; }
+
+  /**
+   * @brief Unsubscribe from body IMU data
+   */
+  void UnsubscribeBodyImu() {}
+
+  /**
+   * @brief Get the number of commands dropped because the echo queue was full.
+   */
+  uint64_t GetDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static std::function<void(JointState&)> InitState(std::size_t joints) {
+    return [joints](JointState& state) { state.joints.resize(joints); };
+  }
+
+  Status Enqueue(Part part, std::size_t joint_num, const JointCommand& command) {
+    if (command.joints.size() != joint_num) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid joint count"};
+    }
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (is_shutdown_.load()) {
+        return {ErrorCode::SERVICE_NOT_READY, "loopback not initialized"};
+      }
+      if (size_ == entries_.size()) {
+        head_ = (head_ + 1) % entries_.size();
+        size_--;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+      }
+      Entry& entry = entries_[(head_ + size_) % entries_.size()];
+      entry.part = part;
+      entry.due_ns = detail::SteadyNowNs() + options_.latency_ns;
+      entry.command.timestamp = command.timestamp;
+      entry.command.joints.assign(command.joints.begin(), command.joints.end());  // reuses the reserved capacity
+      size_++;
+    }
+    queue_cv_.notify_one();
+    return {ErrorCode::OK, ""};
+  }
+
+  void SetCallback(Part part, JointStateCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callbacks_[part] = std::move(callback);
+  }
+
+  void Run() {
+    Entry entry;
+    entry.command.joints.reserve(kArmJointNum);
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [this] { return size_ > 0 || is_shutdown_.load(); });
+        if (is_shutdown_.load()) {
+          return;
+        }
+        int64_t wait_ns = entries_[head_].due_ns - detail::SteadyNowNs();
+        if (wait_ns > 0) {
+          queue_cv_.wait_for(lock, std::chrono::nanoseconds(wait_ns));
+          continue;
+        }
+        std::swap(entry, entries_[head_]);  // keeps the joint storage of both entries
+        head_ = (head_ + 1) % entries_.size();
+        size_--;
+      }
+      Echo(entry);
+    }
+  }
+
+  void Echo(const Entry& entry) {
+    JointStatePtr state = pools_[entry.part].Acquire();
+    state->timestamp = entry.command.timestamp;
+    state->joints.resize(entry.command.joints.size());
+    for (std::size_t ii = 0; ii < entry.command.joints.size(); ii++) {
+      const SingleJointCommand& command = entry.command.joints[ii];
+      SingleJointState& joint = state->joints[ii];
+      joint.status_word = 0;
+      joint.posH = command.pos;
+      joint.posL = command.pos;
+      joint.vel = command.vel;
+      joint.toq = command.toq;
+      joint.current = 0.0;
+      joint.err_code = 0;
+    }
+    // Invoked under the lock so the callback is not copied; callbacks must not re-subscribe
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (callbacks_[entry.part]) {
+      callbacks_[entry.part](state);
+    }
+  }
+
+  const LoopbackOptions options_;
+  std::mutex control_mutex_;  // Serializes Initialize and Shutdown
+  std::atomic_bool is_shutdown_{true};
+  std::thread thread_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::vector<Entry> entries_;  // Ring buffer of commands awaiting their echo
+  std::size_t head_ = 0;
+  std::size_t size_ = 0;
+  std::atomic<uint64_t> dropped_{0};
+
+  std::mutex callback_mutex_;
+  std::array<JointStateCallback, kPartNum> callbacks_;
+  std::array<MessagePool<JointState>, kPartNum> pools_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
@@ -0,0 +1,1074 @@
+#pragma once
+
+#include "magic_message_pool.h"
+#include "magic_motion.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+template <typename Controller = LowLevelMotionController>
+class BasicLowLevelStateHub;
+using LowLevelStateHub = BasicLowLevelStateHub<>;
+using LowLevelStateHubPtr = std::unique_ptr<LowLevelStateHub>;
+
+/**
+ * @brief Whole-body state snapshot of one control cycle
+ *
+ * Part messages are shared with the SDK receive path, no data is copied when building the snapshot.
+ * Parts missing from a partial snapshot are left empty.
+ */
+struct WholeBodyState {
+  int64_t timestamp = 0;              ///< Reference timestamp of the control cycle (unit: nanoseconds)
+  uint8_t parts = kBodyPartNone;      ///< Parts present in the snapshot, combination of BodyPartMask
+  bool has_imu = false;               ///< Whether the body IMU sample is present
+  std::shared_ptr<JointState> arm;    ///< Upper limbs joint state
+  std::shared_ptr<JointState> leg;    ///< Lower limbs joint state
+  std::shared_ptr<JointState> head;   ///< Head joint state
+  std::shared_ptr<JointState> waist;  ///< Waist joint state
+  std::shared_ptr<HandState> hand;    ///< Hand state
+  std::shared_ptr<Imu> imu;           ///< Body IMU data
+};
+
+/**
+ * @brief Whole-body state matching options
+ */
+struct WholeBodyStateOptions {
+  uint8_t parts = kBodyPartAll;    ///< Parts required for a complete snapshot, combination of BodyPartMask
+  bool include_imu = true;         ///< Whether the body IMU sample is required for a complete snapshot
+  int64_t tolerance_ns = 1000000;  ///< Maximum timestamp difference to the cycle reference (unit: nanoseconds)
+  bool deliver_partial = false;    ///< Deliver incomplete snapshots when the next cycle starts instead of dropping them
+};
+
+/**
+ * @brief Whole-body state matching counters
+ */
+struct WholeBodyStateStats {
+  uint64_t complete = 0;  ///< Snapshots delivered with all required parts
+  uint64_t partial = 0;   ///< Incomplete snapshots delivered (deliver_partial enabled)
+  uint64_t dropped = 0;   ///< Incomplete snapshots discarded
+  uint64_t stale = 0;     ///< Part messages older than the current cycle, ignored
+};
+
+/**
+ * @brief Message pool counters of the state hub, one pool per topic
+ */
+struct StateMessagePoolStats {
+  MessagePoolStats arm;    ///< Upper limbs joint state pool
+  MessagePoolStats leg;    ///< Lower limbs joint state pool
+  MessagePoolStats head;   ///< Head joint state pool
+  MessagePoolStats waist;  ///< Waist joint state pool
+  MessagePoolStats hand;   ///< Hand state pool
+  MessagePoolStats imu;    ///< Body IMU pool
+};
+
+/**
+ * @brief Joint state field watched for faults
+ */
+enum class JointFaultField : int8_t {
+  STATUS_WORD = 0,  ///< SingleJointState::status_word
+  ERR_CODE = 1,     ///< SingleJointState::err_code
+};
+
+/**
+ * @brief Change of a joint status word or error code
+ */
+struct JointFaultEvent {
+  BodyPartMask part = kBodyPartNone;                  ///< Body part of the joint
+  uint32_t joint = 0;                                 ///< Joint index in state order
+  JointFaultField field = JointFaultField::ERR_CODE;  ///< Field that changed
+  int16_t old_value = 0;                              ///< Value in the previous message
+  int16_t new_value = 0;                              ///< Value in the current message
+  int64_t timestamp = 0;                              ///< Timestamp of the current message (unit: nanoseconds)
+};
+
+namespace detail {
+
+/**
+ * @brief Copy-on-write listener list.
+ *
+ * Dispatch runs the listeners of the snapshot current when it starts. Remove returns only after every dispatch
+ * started before it has finished, so the state captured by a removed listener may be released right after; a listener
+ * may remove itself or others, its own dispatch is not waited for.
+ */
+template <typename... Args>
+class ListenerList {
+  using Listener = std::function<void(Args...)>;
+  using Entries = std::vector<std::pair<uint64_t, Listener>>;
+
+  // Dispatch running on the current thread, linked across nested dispatches
+  struct Frame {
+    const ListenerList* list;
+    int epoch;
+    const Frame* outer;
+  };
+
+ public:
+  void Add(uint64_t id, Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entries = std::make_shared<Entries>(entries_ ? *entries_ : Entries{});
+    entries->emplace_back(id, std::move(listener));
+    entries_ = std::move(entries);
+  }
+
+  void Remove(uint64_t id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!entries_) {
+      return;
+    }
+    auto entries = std::make_shared<Entries>(*entries_);
+    std::erase_if(*entries, [id](const auto& entry) { return entry.first == id; });
+    entries_ = std::move(entries);
+
+    // Dispatches of the other epoch started before the previous Remove and are drained first, then every dispatch
+    // that may still run the old snapshot is in the current epoch
+    int previous = epoch_;
+    waiters_++;
+    cv_.wait(lock, [&] { return active_[previous ^ 1] == OwnDispatches(previous ^ 1); });
+    epoch_ = previous ^ 1;
+    cv_.wait(lock, [&] { return active_[previous] == OwnDispatches(previous); });
+    waiters_--;
+  }
+
+  void Dispatch(Args... args) const {
+    std::shared_ptr<const Entries> entries;
+    Frame frame{this, 0, current_};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!entries_) {
+        return;
+      }
+      entries = entries_;
+      frame.epoch = epoch_;
+      active_[frame.epoch]++;
+    }
+    current_ = &frame;
+    for (const auto& entry : *entries) {
+      entry.second(args...);
+    }
+    current_ = frame.outer;
+    entries.reset();
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_[frame.epoch]--;
+    if (waiters_ > 0) {
+      cv_.notify_all();
+    }
+  }
+
+ private:
+  // Dispatches of this list in the given epoch the calling thread is inside of
+  int OwnDispatches(int epoch) const {
+    int count = 0;
+    for (const Frame* frame = current_; frame != nullptr; frame = frame->outer) {
+      count += frame->list == this && frame->epoch == epoch;
+    }
+    return count;
+  }
+
+  static inline thread_local const Frame* current_ = nullptr;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  std::shared_ptr<const Entries> entries_;
+  int epoch_ = 0;
+  mutable int active_[2] = {0, 0};  // Dispatches in progress per epoch
+  int waiters_ = 0;
+};
+
+/**
+ * @brief Monotonic clock reading used for sample ages (unit: nanoseconds).
+ */
+inline int64_t SteadyNowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Single-writer sequence lock holding the latest value of a trivially copyable record.
+ *
+ * The writer never waits, readers retry while a write is in progress and never block the writer.
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable record");
+
+ public:
+  /**
+   * @brief Begin an in-place update, the returned record must be fully written before EndWrite.
+   */
+  T& BeginWrite() {
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return value_;
+  }
+
+  void EndWrite() { seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /**
+   * @brief Copy out a consistent record.
+   * @return False if nothing has been written yet.
+   */
+  bool Read(T& out) const {
+    while (true) {
+      uint64_t begin = seq_.load(std::memory_order_acquire);
+      if (begin == 0) {
+        return false;
+      }
+      if (begin & 1) {
+        continue;
+      }
+      std::memcpy(static_cast<void*>(&out), static_cast<const void*>(&value_), sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == begin) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief Copy out a consistent record without retrying, for real-time readers.
+   * @return False if nothing has been written yet or a write overlapped the copy, out is then left unchanged.
+   */
+  bool TryRead(T& out) const {
+    uint64_t begin = seq_.load(std::memory_order_acquire);
+    if (begin == 0 || (begin & 1)) {
+      return false;
+    }
+    T value;
+    std::memcpy(static_cast<void*>(&value), static_cast<const void*>(&value_), sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq_.load(std::memory_order_relaxed) != begin) {
+      return false;
+    }
+    out = value;
+    return true;
+  }
+
+ private:
+  std::atomic<uint64_t> seq_{0};
+  T value_{};
+};
+
+/**
+ * @brief Latest joint state record, stored inline for the seqlock.
+ */
+template <std::size_t N>
+struct JointStateRecord {
+  int64_t timestamp = 0;                   ///< Message timestamp (unit: nanoseconds)
+  int64_t receive_ns = 0;                  ///< Monotonic receive time (unit: nanoseconds)
+  uint32_t count = 0;                      ///< Number of valid joints
+  std::array<SingleJointState, N> joints;  ///< Joint states
+};
+
+/**
+ * @brief Latest structure-of-arrays joint state and its listeners of one body part.
+ */
+template <typename Limb>
+struct JointStateSoAChannel {
+  struct Record {
+    int64_t receive_ns = 0;     ///< Monotonic receive time (unit: nanoseconds)
+    JointStateSoA<Limb> state;  ///< Joint state
+  };
+  SeqLock<Record> latest;
+  ListenerList<const JointStateSoA<Limb>&> listeners;
+};
+
+/**
+ * @brief Status words and error codes of the previous message of one body part, only touched by its receive thread.
+ */
+template <std::size_t N>
+struct JointFaultRecord {
+  std::array<int16_t, N> status_word{};  ///< Previous status words
+  std::array<int16_t, N> err_code{};     ///< Previous error codes
+  std::atomic_bool seeded{false};        ///< Filled from a message, cleared by the hub's Initialize and Shutdown
+};
+
+/**
+ * @brief Latest hand state record, stored inline for the seqlock.
+ */
+struct HandStateRecord {
+  int64_t receive_ns = 0;                        ///< Monotonic receive time (unit: nanoseconds)
+  uint32_t count = 0;                            ///< Number of valid hands
+  std::array<uint32_t, kHandNum> joint_count{};  ///< Number of valid joints of every hand
+  FixedHandState state;                          ///< Hand state, timestamp taken from the message
+};
+
+/**
+ * @brief Latest body IMU record.
+ */
+struct ImuRecord {
+  int64_t receive_ns = 0;  ///< Monotonic receive time (unit: nanoseconds)
+  Imu imu{};               ///< IMU sample
+};
+
+}  // namespace detail
+
+/**
+ * @class BasicLowLevelStateHub
+ * @brief Single owner of the low-level state subscriptions, fanning every message out to any number of consumers.
+ *
+ * LowLevelMotionController keeps one callback per state topic. The hub takes over all six topics (arm, leg, head,
+ * waist, hand and body IMU) on Initialize, and provides latest-value polling, whole-body snapshot matching and
+ * listener registration for SDK extensions and user code. Do not call the controller's Subscribe* interfaces while the hub is initialized.
+ *
+ * @tparam Controller LowLevelMotionController (LowLevelStateHub), or LoopbackMotionController to run the hub without a robot.
+ */
+template <typename Controller>
+class BasicLowLevelStateHub final : public NonCopyable {
+  // Message pointer type definitions (smart pointers for memory management)
+  using JointStatePtr = std::shared_ptr<JointState>;  // Joint state message pointer
+  using HandStatePtr = std::shared_ptr<HandState>;    // Hand state message pointer
+  using ImuPtr = std::shared_ptr<Imu>;                // IMU inertial measurement unit message pointer
+
+  // Listener and callback function type definitions
+  using JointStateListener = std::function<void(BodyPartMask, const JointStatePtr&)>;  // Joint state listener, tagged with body part
+  using HandStateListener = std::function<void(const HandStatePtr&)>;                  // Hand state listener
+  using FixedHandStateListener = std::function<void(const FixedHandState&)>;           // Fixed-size hand state listener
+  using ImuListener = std::function<void(const ImuPtr&)>;                              // Body IMU listener
+  using WholeBodyStateCallback = std::function<void(const WholeBodyState&)>;           // Whole-body snapshot callback
+  using JointFaultListener = std::function<void(const JointFaultEvent&)>;             // Joint fault event listener
+  template <typename Limb>
+  using JointStateSoAListener = std::function<void(const JointStateSoA<Limb>&)>;  // Structure-of-arrays joint state listener
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param controller Low-level motion controller whose state topics are taken over.
+   * @param pool_capacity Number of recycled messages preallocated per topic for the Acquire* interfaces.
+   */
+  explicit BasicLowLevelStateHub(Controller& controller, std::size_t pool_capacity = 8)
+      : controller_(controller),
+        arm_pool_(pool_capacity, [](JointState& msg) { msg.joints.resize(kArmJointNum); }),
+        leg_pool_(pool_capacity, [](JointState& msg) { msg.joints.resize(kLegJointNum); }),
+        head_pool_(pool_capacity, [](JointState& msg) { msg.joints.resize(kHeadJointNum); }),
+        waist_pool_(pool_capacity, [](JointState& msg) { msg.joints.resize(kWaistJointNum); }),
+        hand_pool_(pool_capacity, [](HandState& msg) {
+          msg.state.resize(kHandNum);
+          for (auto& hand : msg.state) {
+            hand.pos.resize(kHandJointNum);
+            hand.toq.resize(kHandJointNum);
+            hand.cur.resize(kHandJointNum);
+          }
+        }),
+        imu_pool_(pool_capacity) {}
+
+  /// Destructor, releases the state subscriptions.
+  ~BasicLowLevelStateHub() { Shutdown(); }
+
+  /**
+   * @brief Subscribe to all low-level state topics of the controller.
+   * @return Whether initialization was successful.
+   */
+  bool Initialize() {
+    if (!is_shutdown_.exchange(false)) {
+      return true;
+    }
+    ResetFaultRecords();
+    controller_.SubscribeArmState([this](const JointStatePtr msg) { OnJointState(kBodyPartArm, msg); });
+    controller_.SubscribeLegState([this](const JointStatePtr msg) { OnJointState(kBodyPartLeg, msg); });
+    controller_.SubscribeHeadState([this](const JointStatePtr msg) { OnJointState(kBodyPartHead, msg); });
+    controller_.SubscribeWaistState([this](const JointStatePtr msg) { OnJointState(kBodyPartWaist, msg); });
+    controller_.SubscribeHandState([this](const HandStatePtr msg) { OnHandState(msg); });
+    controller_.SubscribeBodyImu([this](const ImuPtr msg) { OnBodyImu(msg); });
+    return true;
+  }
+
+  /**
+   * @brief Unsubscribe from all low-level state topics.
+   */
+  void Shutdown() {
+    if (is_shutdown_.exchange(true)) {
+      return;
+    }
+    controller_.UnsubscribeArmState();
+    controller_.UnsubscribeLegState();
+    controller_.UnsubscribeHeadState();
+    controller_.UnsubscribeWaistState();
+    controller_.UnsubscribeHandState();
+    controller_.UnsubscribeBodyImu();
+    ResetFaultRecords();
+  }
+
+  // === Listeners ===
+
+  /**
+   * @brief Register a listener for arm, leg, head and waist joint states.
+   * @param listener Called on the SDK receive thread with the body part and the message, must not block.
+   * @return Listener id for RemoveListener.
+   */
+  uint64_t AddJointStateListener(JointStateListener listener) {
+    uint64_t id = ++next_listener_id_;
+    joint_listeners_.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Register a listener for hand states.
+   * @param listener Called on the SDK receive thread, must not block.
+   * @return Listener id for RemoveListener.
+   */
+  uint64_t AddHandStateListener(HandStateListener listener) {
+    uint64_t id = ++next_listener_id_;
+    hand_listeners_.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Register a fixed-size hand state listener.
+   *
+   * Every hand message is copied once on the SDK receive thread into a preallocated FixedHandState, so listeners
+   * never allocate. Degrees of freedom missing from the message keep their previous value.
+   *
+   * @param listener Called on the SDK receive thread, must not block. The state is only valid during the call.
+   * @return Listener id for RemoveListener.
+   */
+  uint64_t AddFixedHandStateListener(FixedHandStateListener listener) {
+    uint64_t id = ++next_listener_id_;
+    fixed_hand_listeners_.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Register a listener for body IMU data.
+   * @param listener Called on the SDK receive thread, must not block.
+   * @return Listener id for RemoveListener.
+   */
+  uint64_t AddBodyImuListener(ImuListener listener) {
+    uint64_t id = ++next_listener_id_;
+    imu_listeners_.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Register a structure-of-arrays joint state listener for one body part.
+   *
+   * Every message of the body part is converted once on the SDK receive thread, straight from the received message,
+   * so listeners get contiguous per-field arrays without converting the joint records themselves.
+   *
+   * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+   * @param listener Called on the SDK receive thread, must not block. The state is only valid during the call.
+   * @return Listener id for RemoveListener.
+   */
+  template <typename Limb>
+  uint64_t AddJointStateSoAListener(JointStateSoAListener<Limb> listener) {
+    uint64_t id = ++next_listener_id_;
+    SoAChannel<Limb>(*this).listeners.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Register a listener for joint status word and error code changes.
+   *
+   * The hub compares the status word and error code of every joint with the previous message of the same body part,
+   * and calls the listener once per changed field, so faults need not be scanned for in every state callback. The
+   * first message of a body part after Initialize only records the current values, no change is reported for it.
+   *
+   * @param listener Called on the SDK receive thread, must not block.
+   * @return Listener id for RemoveListener.
+   */
+  uint64_t AddJointFaultListener(JointFaultListener listener) {
+    uint64_t id = ++next_listener_id_;
+    fault_listeners_.Add(id, std::move(listener));
+    return id;
+  }
+
+  /**
+   * @brief Remove a listener registered with any Add*Listener interface.
+   * @param id Listener id.
+   */
+  void RemoveListener(uint64_t id) {
+    joint_listeners_.Remove(id);
+    hand_listeners_.Remove(id);
+    fixed_hand_listeners_.Remove(id);
+    imu_listeners_.Remove(id);
+    fault_listeners_.Remove(id);
+    arm_soa_.listeners.Remove(id);
+    leg_soa_.listeners.Remove(id);
+    head_soa_.listeners.Remove(id);
+    waist_soa_.listeners.Remove(id);
+  }
+
+  // === Latest State Polling ===
+
+  /**
+   * @brief Copy the latest arm joint state, never blocks the SDK receive thread.
+   * @param[out] state Latest arm joint state, joint storage is reused and only grows on the first call.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestArmState(JointState& state) const { return ReadLatest(latest_arm_, state); }
+
+  /**
+   * @brief Copy the latest leg joint state, never blocks the SDK receive thread.
+   * @param[out] state Latest leg joint state, joint storage is reused and only grows on the first call.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestLegState(JointState& state) const { return ReadLatest(latest_leg_, state); }
+
+  /**
+   * @brief Copy the latest head joint state, never blocks the SDK receive thread.
+   * @param[out] state Latest head joint state, joint storage is reused and only grows on the first call.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestHeadState(JointState& state) const { return ReadLatest(latest_head_, state); }
+
+  /**
+   * @brief Copy the latest waist joint state, never blocks the SDK receive thread.
+   * @param[out] state Latest waist joint state, joint storage is reused and only grows on the first call.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestWaistState(JointState& state) const { return ReadLatest(latest_waist_, state); }
+
+  /**
+   * @brief Copy the latest arm joint state into a fixed-size state, never allocates.
+   * @param[out] state Latest arm joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestArmState(ArmJointState& state) const { return ReadLatest(latest_arm_, state); }
+
+  /**
+   * @brief Copy the latest leg joint state into a fixed-size state, never allocates.
+   * @param[out] state Latest leg joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestLegState(LegJointState& state) const { return ReadLatest(latest_leg_, state); }
+
+  /**
+   * @brief Copy the latest head joint state into a fixed-size state, never allocates.
+   * @param[out] state Latest head joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestHeadState(HeadJointState& state) const { return ReadLatest(latest_head_, state); }
+
+  /**
+   * @brief Copy the latest waist joint state into a fixed-size state, never allocates.
+   * @param[out] state Latest waist joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestWaistState(WaistJointState& state) const { return ReadLatest(latest_waist_, state); }
+
+  /**
+   * @brief Copy the latest arm joint state as structure of arrays, never allocates.
+   * @param[out] state Latest arm joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestArmState(ArmJointStateSoA& state) const { return ReadLatestSoA(arm_soa_, state); }
+
+  /**
+   * @brief Copy the latest leg joint state as structure of arrays, never allocates.
+   * @param[out] state Latest leg joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestLegState(LegJointStateSoA& state) const { return ReadLatestSoA(leg_soa_, state); }
+
+  /**
+   * @brief Copy the latest head joint state as structure of arrays, never allocates.
+   * @param[out] state Latest head joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestHeadState(HeadJointStateSoA& state) const { return ReadLatestSoA(head_soa_, state); }
+
+  /**
+   * @brief Copy the latest waist joint state as structure of arrays, never allocates.
+   * @param[out] state Latest waist joint state, joints missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestWaistState(WaistJointStateSoA& state) const { return ReadLatestSoA(waist_soa_, state); }
+
+  /**
+   * @brief Copy the latest hand state, never blocks the SDK receive thread.
+   * @param[out] state Latest hand state, storage is reused and only grows on the first call.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestHandState(HandState& state) const {
+    detail::HandStateRecord record;
+    if (!latest_hand_.Read(record)) {
+      return -1;
+    }
+    state.timestamp = record.state.timestamp;
+    state.state.resize(record.count);
+    for (uint32_t ii = 0; ii < record.count; ii++) {
+      const auto& hand = record.state.hands[ii];
+      auto& out = state.state[ii];
+      uint32_t count = record.joint_count[ii];
+      out.status_word = hand.status_word;
+      out.error_code = hand.error_code;
+      out.pos.assign(hand.pos.begin(), hand.pos.begin() + count);
+      out.toq.assign(hand.toq.begin(), hand.toq.begin() + count);
+      out.cur.assign(hand.cur.begin(), hand.cur.begin() + count);
+    }
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  /**
+   * @brief Copy the latest hand state into a fixed-size state, never allocates.
+   * @param[out] state Latest hand state, values missing from the message keep their previous value.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestHandState(FixedHandState& state) const {
+    detail::HandStateRecord record;
+    if (!latest_hand_.Read(record)) {
+      return -1;
+    }
+    state = record.state;
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  /**
+   * @brief Copy the latest body IMU sample, never blocks the SDK receive thread.
+   * @param[out] imu Latest body IMU sample.
+   * @return Age of the sample since it was received (unit: nanoseconds), negative if no sample was received yet.
+   */
+  int64_t GetLatestBodyImu(Imu& imu) const {
+    detail::ImuRecord record;
+    if (!latest_imu_.Read(record)) {
+      return -1;
+    }
+    imu = record.imu;
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  /**
+   * @brief Acquire a pooled copy of the latest arm joint state, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  JointStatePtr AcquireLatestArmState(int64_t* age_ns = nullptr) { return AcquireLatest(arm_pool_, latest_arm_, age_ns); }
+
+  /**
+   * @brief Acquire a pooled copy of the latest leg joint state, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  JointStatePtr AcquireLatestLegState(int64_t* age_ns = nullptr) { return AcquireLatest(leg_pool_, latest_leg_, age_ns); }
+
+  /**
+   * @brief Acquire a pooled copy of the latest head joint state, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  JointStatePtr AcquireLatestHeadState(int64_t* age_ns = nullptr) { return AcquireLatest(head_pool_, latest_head_, age_ns); }
+
+  /**
+   * @brief Acquire a pooled copy of the latest waist joint state, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  JointStatePtr AcquireLatestWaistState(int64_t* age_ns = nullptr) { return AcquireLatest(waist_pool_, latest_waist_, age_ns); }
+
+  /**
+   * @brief Acquire a pooled copy of the latest hand state, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  HandStatePtr AcquireLatestHandState(int64_t* age_ns = nullptr) {
+    auto msg = hand_pool_.Acquire();
+    int64_t age = GetLatestHandState(*msg);
+    if (age_ns != nullptr) {
+      *age_ns = age;
+    }
+    return age < 0 ? nullptr : msg;
+  }
+
+  /**
+   * @brief Acquire a pooled copy of the latest body IMU sample, which may be kept beyond the current control cycle.
+   * @param[out] age_ns Optional, age of the sample since it was received (unit: nanoseconds).
+   * @return Recycled message returned to the pool when dropped, nullptr if no sample was received yet.
+   */
+  ImuPtr AcquireLatestBodyImu(int64_t* age_ns = nullptr) {
+    auto msg = imu_pool_.Acquire();
+    int64_t age = GetLatestBodyImu(*msg);
+    if (age_ns != nullptr) {
+      *age_ns = age;
+    }
+    return age < 0 ? nullptr : msg;
+  }
+
+  /**
+   * @brief Get message pool counters, used to size pool_capacity.
+   * @return Hit and miss counters of every topic pool.
+   */
+  StateMessagePoolStats GetMessagePoolStats() const {
+    StateMessagePoolStats stats;
+    stats.arm = arm_pool_.GetStats();
+    stats.leg = leg_pool_.GetStats();
+    stats.head = head_pool_.GetStats();
+    stats.waist = waist_pool_.GetStats();
+    stats.hand = hand_pool_.GetStats();
+    stats.imu = imu_pool_.GetStats();
+    return stats;
+  }
+
+  // === Whole Body State ===
+
+  /**
+   * @brief Subscribe to whole-body state snapshots matched on message timestamps.
+   * @param callback Called once per control cycle on the SDK receive thread that completed the snapshot.
+   * @param options Required parts and matching tolerance.
+   * @note The callback may subscribe or unsubscribe itself. Once (Un)SubscribeWholeBodyState returns, the previous
+   *       callback is no longer running on another thread.
+   */
+  void SubscribeWholeBodyState(WholeBodyStateCallback callback, const WholeBodyStateOptions& options = {}) {
+    bool enabled = static_cast<bool>(callback);
+    whole_body_listener_.Remove(0);
+    if (enabled) {
+      whole_body_listener_.Add(0, std::move(callback));
+    }
+    std::lock_guard<std::mutex> lock(whole_body_mutex_);
+    whole_body_options_ = options;
+    whole_body_enabled_ = enabled;
+    pending_ = WholeBodyState{};
+  }
+
+  /**
+   * @brief Unsubscribe from whole-body state snapshots.
+   */
+  void UnsubscribeWholeBodyState() {
+    {
+      std::lock_guard<std::mutex> lock(whole_body_mutex_);
+      whole_body_enabled_ = false;
+      pending_ = WholeBodyState{};
+    }
+    whole_body_listener_.Remove(0);
+  }
+
+  /**
+   * @brief Get whole-body state matching counters.
+   * @return Counters accumulated since construction.
+   */
+  WholeBodyStateStats GetWholeBodyStateStats() const {
+    WholeBodyStateStats stats;
+    stats.complete = complete_count_.load(std::memory_order_relaxed);
+    stats.partial = partial_count_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_count_.load(std::memory_order_relaxed);
+    stats.stale = stale_count_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  void OnJointState(BodyPartMask part, const JointStatePtr& msg) {
+    int64_t receive_ns = detail::SteadyNowNs();
+    switch (part) {
+      case kBodyPartArm:
+        WriteLatest(latest_arm_, *msg, receive_ns);
+        WriteLatestSoA(arm_soa_, *msg, receive_ns);
+        DetectFaults(part, arm_faults_, *msg);
+        break;
+      case kBodyPartLeg:
+        WriteLatest(latest_leg_, *msg, receive_ns);
+        WriteLatestSoA(leg_soa_, *msg, receive_ns);
+        DetectFaults(part, leg_faults_, *msg);
+        break;
+      case kBodyPartHead:
+        WriteLatest(latest_head_, *msg, receive_ns);
+        WriteLatestSoA(head_soa_, *msg, receive_ns);
+        DetectFaults(part, head_faults_, *msg);
+        break;
+      case kBodyPartWaist:
+        WriteLatest(latest_waist_, *msg, receive_ns);
+        WriteLatestSoA(waist_soa_, *msg, receive_ns);
+        DetectFaults(part, waist_faults_, *msg);
+        break;
+      default:
+        break;
+    }
+    joint_listeners_.Dispatch(part, msg);
+    MatchWholeBody(part, msg->timestamp, [part, &msg](WholeBodyState& snapshot) {
+      switch (part) {
+        case kBodyPartArm:
+          snapshot.arm = msg;
+          break;
+        case kBodyPartLeg:
+          snapshot.leg = msg;
+          break;
+        case kBodyPartHead:
+          snapshot.head = msg;
+          break;
+        case kBodyPartWaist:
+          snapshot.waist = msg;
+          break;
+        default:
+          return;
+      }
+      snapshot.parts |= part;
+    });
+  }
+
+  void OnHandState(const HandStatePtr& msg) {
+    auto& record = latest_hand_.BeginWrite();
+    record.receive_ns = detail::SteadyNowNs();
+    record.state.timestamp = msg->timestamp;
+    record.count = static_cast<uint32_t>(std::min<std::size_t>(msg->state.size(), kHandNum));
+    for (uint32_t ii = 0; ii < record.count; ii++) {
+      const auto& hand = msg->state[ii];
+      auto& out = record.state.hands[ii];
+      uint32_t count = static_cast<uint32_t>(std::min<std::size_t>({hand.pos.size(), hand.toq.size(), hand.cur.size(), kHandJointNum}));
+      record.joint_count[ii] = count;
+      out.status_word = hand.status_word;
+      out.error_code = hand.error_code;
+      std::copy_n(hand.pos.begin(), count, out.pos.begin());
+      std::copy_n(hand.toq.begin(), count, out.toq.begin());
+      std::copy_n(hand.cur.begin(), count, out.cur.begin());
+    }
+    latest_hand_.EndWrite();
+    // Only this receive thread writes the record, it stays unchanged while the listeners run
+    fixed_hand_listeners_.Dispatch(record.state);
+    hand_listeners_.Dispatch(msg);
+    MatchWholeBody(kBodyPartHand, msg->timestamp, [&msg](WholeBodyState& snapshot) {
+      snapshot.hand = msg;
+      snapshot.parts |= kBodyPartHand;
+    });
+  }
+
+  void OnBodyImu(const ImuPtr& msg) {
+    auto& record = latest_imu_.BeginWrite();
+    record.receive_ns = detail::SteadyNowNs();
+    record.imu = *msg;
+    latest_imu_.EndWrite();
+    imu_listeners_.Dispatch(msg);
+    MatchWholeBody(kBodyPartNone, msg->timestamp, [&msg](WholeBodyState& snapshot) {
+      snapshot.imu = msg;
+      snapshot.has_imu = true;
+    });
+  }
+
+  template <std::size_t N>
+  static void WriteLatest(detail::SeqLock<detail::JointStateRecord<N>>& latest, const JointState& msg, int64_t receive_ns) {
+    auto& record = latest.BeginWrite();
+    record.timestamp = msg.timestamp;
+    record.receive_ns = receive_ns;
+    record.count = static_cast<uint32_t>(std::min(msg.joints.size(), N));
+    std::copy_n(msg.joints.begin(), record.count, record.joints.begin());
+    latest.EndWrite();
+  }
+
+  template <std::size_t N>
+  static int64_t ReadLatest(const detail::SeqLock<detail::JointStateRecord<N>>& latest, JointState& state) {
+    detail::JointStateRecord<N> record;
+    if (!latest.Read(record)) {
+      return -1;
+    }
+    state.timestamp = record.timestamp;
+    state.joints.assign(record.joints.begin(), record.joints.begin() + record.count);
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  template <std::size_t N, typename Limb>
+  static int64_t ReadLatest(const detail::SeqLock<detail::JointStateRecord<N>>& latest, JointStateT<Limb>& state) {
+    static_assert(N == Limb::kJointNum, "joint state record does not match the limb");
+    detail::JointStateRecord<N> record;
+    if (!latest.Read(record)) {
+      return -1;
+    }
+    state.timestamp = record.timestamp;
+    std::copy_n(record.joints.begin(), record.count, state.joints.begin());
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  template <typename Limb>
+  static void WriteLatestSoA(detail::JointStateSoAChannel<Limb>& channel, const JointState& msg, int64_t receive_ns) {
+    auto& record = channel.latest.BeginWrite();
+    record.receive_ns = receive_ns;
+    auto& state = record.state;
+    state.timestamp = msg.timestamp;
+    std::size_t count = std::min(msg.joints.size(), Limb::kJointNum);
+    for (std::size_t ii = 0; ii < count; ii++) {
+      const SingleJointState& joint = msg.joints[ii];
+      state.status_word[ii] = joint.status_word;
+      state.posH[ii] = joint.posH;
+      state.posL[ii] = joint.posL;
+      state.vel[ii] = joint.vel;
+      state.toq[ii] = joint.toq;
+      state.current[ii] = joint.current;
+      state.err_code[ii] = joint.err_code;
+    }
+    channel.latest.EndWrite();
+    // Only this receive thread writes the record, it stays unchanged while the listeners run
+    channel.listeners.Dispatch(state);
+  }
+
+  template <typename Limb>
+  static int64_t ReadLatestSoA(const detail::JointStateSoAChannel<Limb>& channel, JointStateSoA<Limb>& state) {
+    typename detail::JointStateSoAChannel<Limb>::Record record;
+    if (!channel.latest.Read(record)) {
+      return -1;
+    }
+    state = record.state;
+    return detail::SteadyNowNs() - record.receive_ns;
+  }
+
+  template <typename Limb, typename Self>
+  static auto& SoAChannel(Self& self) {
+    if constexpr (std::is_same_v<Limb, ArmLimb>) {
+      return self.arm_soa_;
+    } else if constexpr (std::is_same_v<Limb, LegLimb>) {
+      return self.leg_soa_;
+    } else if constexpr (std::is_same_v<Limb, HeadLimb>) {
+      return self.head_soa_;
+    } else {
+      static_assert(std::is_same_v<Limb, WaistLimb>, "unsupported limb descriptor");
+      return self.waist_soa_;
+    }
+  }
+
+  // The values before the first message are unknown, reporting them as 0 would flag every enabled motor
+  template <std::size_t N>
+  void DetectFaults(BodyPartMask part, detail::JointFaultRecord<N>& previous, const JointState& msg) const {
+    std::size_t count = std::min(msg.joints.size(), N);
+    if (!previous.seeded.load(std::memory_order_relaxed)) [[unlikely]] {
+      for (std::size_t ii = 0; ii < count; ii++) {
+        previous.status_word[ii] = msg.joints[ii].status_word;
+        previous.err_code[ii] = msg.joints[ii].err_code;
+      }
+      previous.seeded.store(true, std::memory_order_relaxed);
+      return;
+    }
+    for (std::size_t ii = 0; ii < count; ii++) {
+      const SingleJointState& joint = msg.joints[ii];
+      if (joint.status_word != previous.status_word[ii]) [[unlikely]] {
+        fault_listeners_.Dispatch(JointFaultEvent{part, static_cast<uint32_t>(ii), JointFaultField::STATUS_WORD,
+                                                  previous.status_word[ii], joint.status_word, msg.timestamp});
+        previous.status_word[ii] = joint.status_word;
+      }
+      if (joint.err_code != previous.err_code[ii]) [[unlikely]] {
+        fault_listeners_.Dispatch(JointFaultEvent{part, static_cast<uint32_t>(ii), JointFaultField::ERR_CODE,
+                                                  previous.err_code[ii], joint.err_code, msg.timestamp});
+        previous.err_code[ii] = joint.err_code;
+      }
+    }
+  }
+
+  void ResetFaultRecords() {
+    arm_faults_.seeded.store(false, std::memory_order_relaxed);
+    leg_faults_.seeded.store(false, std::memory_order_relaxed);
+    head_faults_.seeded.store(false, std::memory_order_relaxed);
+    waist_faults_.seeded.store(false, std::memory_order_relaxed);
+  }
+
+  template <std::size_t N>
+  static JointStatePtr AcquireLatest(MessagePool<JointState>& pool, const detail::SeqLock<detail::JointStateRecord<N>>& latest, int64_t* age_ns) {
+    auto msg = pool.Acquire();
+    int64_t age = ReadLatest(latest, *msg);
+    if (age_ns != nullptr) {
+      *age_ns = age;
+    }
+    return age < 0 ? nullptr : msg;
+  }
+
+  /**
+   * @brief Place one part message into the pending snapshot, delivering the snapshot when it completes.
+   * @param part Body part of the message, kBodyPartNone for the body IMU.
+   * @param timestamp Message timestamp (unit: nanoseconds).
+   * @param fill Stores the message into the snapshot.
+   */
+  template <typename Fill>
+  void MatchWholeBody(BodyPartMask part, int64_t timestamp, Fill&& fill) {
+    WholeBodyState ready[2];  // At most the superseded partial snapshot and the completed one
+    int ready_count = 0;
+    {
+      std::lock_guard<std::mutex> lock(whole_body_mutex_);
+      if (!whole_body_enabled_) {
+        return;
+      }
+      const auto& options = whole_body_options_;
+      // Streams not required for a snapshot neither join nor reset the pending cycle
+      if (part == kBodyPartNone ? !options.include_imu : (options.parts & part) == 0) {
+        return;
+      }
+      bool empty = pending_.parts == kBodyPartNone && !pending_.has_imu;
+      if (!empty && timestamp < pending_.timestamp - options.tolerance_ns) {
+        stale_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (!empty && timestamp > pending_.timestamp + options.tolerance_ns) {
+        // A newer control cycle started before the pending one completed
+        if (options.deliver_partial) {
+          partial_count_.fetch_add(1, std::memory_order_relaxed);
+          ready[ready_count++] = std::move(pending_);
+        } else {
+          dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending_ = WholeBodyState{};
+        empty = true;
+      }
+      if (empty) {
+        pending_.timestamp = timestamp;
+      }
+      fill(pending_);
+      if ((pending_.parts & options.parts) == options.parts && (pending_.has_imu || !options.include_imu)) {
+        complete_count_.fetch_add(1, std::memory_order_relaxed);
+        ready[ready_count++] = std::move(pending_);
+        pending_ = WholeBodyState{};
+      }
+    }
+    if (ready_count > 0) {
+      std::lock_guard<std::mutex> lock(delivery_mutex_);
+      for (int ii = 0; ii < ready_count; ii++) {
+        whole_body_listener_.Dispatch(ready[ii]);
+      }
+    }
+  }
+
+  Controller& controller_;
+  std::atomic_bool is_shutdown_{true};  // Flag indicating whether initialized
+
+  std::atomic<uint64_t> next_listener_id_{0};
+  detail::ListenerList<BodyPartMask, const JointStatePtr&> joint_listeners_;
+  detail::ListenerList<const HandStatePtr&> hand_listeners_;
+  detail::ListenerList<const FixedHandState&> fixed_hand_listeners_;
+  detail::ListenerList<const ImuPtr&> imu_listeners_;
+  detail::ListenerList<const JointFaultEvent&> fault_listeners_;
+
+  // Latest samples for polling
+  detail::SeqLock<detail::JointStateRecord<kArmJointNum>> latest_arm_;
+  detail::SeqLock<detail::JointStateRecord<kLegJointNum>> latest_leg_;
+  detail::SeqLock<detail::JointStateRecord<kHeadJointNum>> latest_head_;
+  detail::SeqLock<detail::JointStateRecord<kWaistJointNum>> latest_waist_;
+  detail::SeqLock<detail::HandStateRecord> latest_hand_;
+  detail::SeqLock<detail::ImuRecord> latest_imu_;
+
+  // Structure-of-arrays joint states, filled on the receive threads
+  detail::JointStateSoAChannel<ArmLimb> arm_soa_;
+  detail::JointStateSoAChannel<LegLimb> leg_soa_;
+  detail::JointStateSoAChannel<HeadLimb> head_soa_;
+  detail::JointStateSoAChannel<WaistLimb> waist_soa_;
+
+  // Previous status words and error codes, diffed on the receive threads
+  detail::JointFaultRecord<kArmJointNum> arm_faults_;
+  detail::JointFaultRecord<kLegJointNum> leg_faults_;
+  detail::JointFaultRecord<kHeadJointNum> head_faults_;
+  detail::JointFaultRecord<kWaistJointNum> waist_faults_;
+
+  // Recycled messages for the Acquire* interfaces
+  MessagePool<JointState> arm_pool_;
+  MessagePool<JointState> leg_pool_;
+  MessagePool<JointState> head_pool_;
+  MessagePool<JointState> waist_pool_;
+  MessagePool<HandState> hand_pool_;
+  MessagePool<Imu> imu_pool_;
+
+  std::mutex whole_body_mutex_;                                      // Guards the pending snapshot and options
+  std::mutex delivery_mutex_;                                        // Serializes whole-body callbacks across receive threads
+  detail::ListenerList<const WholeBodyState&> whole_body_listener_;  // Single whole-body callback, invoked without any lock held
+  WholeBodyStateOptions whole_body_options_;
+  bool whole_body_enabled_ = false;
+  WholeBodyState pending_;
+  std::atomic<uint64_t> complete_count_{0};
+  std::atomic<uint64_t> partial_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+  std::atomic<uint64_t> stale_count_{0};
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
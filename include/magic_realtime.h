@@ -0,0 +1,321 @@
+#pragma once
+
+#include "magic_histogram.h"
+#include "magic_type.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace magic::gen1 {
+
+class RtControlLoop;
+using RtControlLoopPtr = std::unique_ptr<RtControlLoop>;
+
+namespace detail {
+
+/**
+ * @brief Create a thread with optional SCHED_FIFO priority and CPU affinity.
+ * @param[out] thread Created thread handle.
+ * @param entry Thread entry function.
+ * @param arg Argument passed to the entry function.
+ * @param priority SCHED_FIFO priority [1, 99], 0 keeps the default scheduler.
+ * @param cpu CPU core the thread is pinned to, -1 means no pinning.
+ * @param name Thread name, truncated to 15 characters.
+ * @return 0 on success, otherwise the error number.
+ */
+inline int CreateThread(pthread_t& thread, void* (*entry)(void*), void* arg, int priority, int cpu, const std::string& name) {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  int ret = 0;
+  if (priority > 0) {
+    sched_param param{};
+    param.sched_priority = priority;
+    ret = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    if (ret == 0) {
+      ret = pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    }
+    if (ret == 0) {
+      ret = pthread_attr_setschedparam(&attr, &param);
+    }
+  }
+  if (ret == 0 && cpu >= 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    ret = pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+  }
+  if (ret == 0) {
+    ret = pthread_create(&thread, &attr, entry, arg);
+  }
+  pthread_attr_destroy(&attr);
+  if (ret == 0) {
+    pthread_setname_np(thread, name.substr(0, 15).c_str());
+  }
+  return ret;
+}
+
+/**
+ * @brief Mutex with priority inheritance, for state shared between a real-time thread and application threads.
+ *
+ * While an application thread holds the lock, a real-time thread waiting for it lends its SCHED_FIFO priority to the
+ * holder, so a preempted low-priority holder cannot stall the real-time loop. Usable with std::lock_guard.
+ */
+class PriorityInheritanceMutex final : public NonCopyable {
+ public:
+  PriorityInheritanceMutex() {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&mutex_, &attr);
+    pthread_mutexattr_destroy(&attr);
+  }
+
+  ~PriorityInheritanceMutex() { pthread_mutex_destroy(&mutex_); }
+
+  void lock() { pthread_mutex_lock(&mutex_); }
+  bool try_lock() { return pthread_mutex_trylock(&mutex_) == 0; }
+  void unlock() { pthread_mutex_unlock(&mutex_); }
+
+ private:
+  pthread_mutex_t mutex_;
+};
+
+}  // namespace detail
+
+/**
+ * @brief Real-time control loop configuration
+ */
+struct RtControlLoopOptions {
+  int64_t period_ns = 2000000;           ///< Loop period (unit: nanoseconds), default 2ms (500Hz)
+  int priority = 90;                     ///< SCHED_FIFO priority [1, 99], 0 keeps the default scheduler
+  int cpu = -1;                          ///< CPU core the loop thread is pinned to, -1 means no pinning
+  bool lock_memory = true;               ///< Lock current and future pages in RAM with mlockall
+  bool skip_missed_cycles = true;        ///< After an overrun, skip missed deadlines instead of running them back-to-back
+  std::string name = "magic_rt_loop";    ///< Thread name, truncated to 15 characters
+  int64_t histogram_range_ns = 1000000;  ///< Jitter histogram range, period histogram covers period +/- this value
+  std::size_t histogram_bins = 200;      ///< Number of histogram bins
+};
+
+/**
+ * @brief Information about the current cycle passed to the step function
+ */
+struct RtCycleInfo {
+  uint64_t cycle = 0;       ///< Cycle index, starting from 0
+  int64_t deadline_ns = 0;  ///< Scheduled wakeup time on CLOCK_MONOTONIC (unit: nanoseconds)
+  int64_t wakeup_ns = 0;    ///< Actual wakeup time on CLOCK_MONOTONIC (unit: nanoseconds)
+};
+
+/**
+ * @brief Real-time control loop counters and timing distributions (unit: nanoseconds)
+ */
+struct RtControlLoopStats {
+  uint64_t cycles = 0;          ///< Executed cycles
+  uint64_t overruns = 0;        ///< Cycles whose step finished after the next deadline
+  uint64_t skipped_cycles = 0;  ///< Deadlines skipped after overruns
+  HistogramSnapshot period;     ///< Time between consecutive wakeups
+  HistogramSnapshot jitter;     ///< Wakeup time minus scheduled deadline
+  HistogramSnapshot step_time;  ///< Execution time of the step function
+};
+
+/**
+ * @class RtControlLoop
+ * @brief Runs a step function at a fixed period on a dedicated real-time thread.
+ *
+ * The thread uses SCHED_FIFO with the configured priority and CPU affinity, sleeps on absolute CLOCK_MONOTONIC
+ * deadlines with clock_nanosleep so the period does not drift, and records period, jitter and step time histograms.
+ * Real-time scheduling requires the rtprio limit described in the README.
+ */
+class RtControlLoop final : public NonCopyable {
+  using StepFunction = std::function<void(const RtCycleInfo&)>;  // Step function called once per cycle
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param options Loop configuration.
+   */
+  explicit RtControlLoop(const RtControlLoopOptions& options = {})
+      : options_(options),
+        period_(static_cast<double>(options.period_ns - options.histogram_range_ns), static_cast<double>(options.period_ns + options.histogram_range_ns), options.histogram_bins),
+        jitter_(0.0, static_cast<double>(options.histogram_range_ns), options.histogram_bins),
+        step_time_(0.0, static_cast<double>(options.period_ns), options.histogram_bins) {}
+
+  /// Destructor, stops the loop.
+  ~RtControlLoop() { Stop(); }
+
+  /**
+   * @brief Start the loop thread.
+   * @param step Step function, called once per period on the loop thread. It must not block.
+   * @return Execution status, fails if the period or histogram range is not positive or the real-time attributes cannot
+   *         be applied (e.g. missing rtprio permission).
+   */
+  Status Start(StepFunction step) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (running_.load()) {
+      return {ErrorCode::SERVICE_ERROR, "control loop already running"};
+    }
+    Join();
+    if (options_.period_ns <= 0 || options_.histogram_range_ns <= 0 || !step) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid period, histogram range or empty step function"};
+    }
+    if (options_.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      return {ErrorCode::INTERNAL_ERROR, std::string("mlockall failed: ") + std::strerror(errno)};
+    }
+
+    step_ = std::move(step);
+    running_.store(true);
+    int ret = detail::CreateThread(thread_, &RtControlLoop::ThreadEntry, this, options_.priority, options_.cpu, options_.name);
+    if (ret != 0) {
+      running_.store(false);
+      step_ = nullptr;
+      return {ErrorCode::INTERNAL_ERROR, std::string("failed to create real-time thread: ") + std::strerror(ret)};
+    }
+    joinable_ = true;
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Stop the loop and wait for the current cycle to finish.
+   * @note Must not be called from the step function, use RequestStop there.
+   */
+  void Stop() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    running_.store(false);
+    Join();
+  }
+
+  /**
+   * @brief End the loop after the current cycle without waiting for it, the thread is joined by the next Start or Stop.
+   * @note May be called from the step function.
+   */
+  void RequestStop() { running_.store(false); }
+
+  /**
+   * @brief Whether the loop thread is running.
+   */
+  bool IsRunning() const { return running_.load(); }
+
+  /**
+   * @brief Get loop counters and timing histograms.
+   * @return Statistics accumulated since construction or the last ResetStats.
+   */
+  RtControlLoopStats GetStats() const {
+    RtControlLoopStats stats;
+    stats.cycles = cycles_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.skipped_cycles = skipped_cycles_.load(std::memory_order_relaxed);
+    stats.period = period_.Snapshot();
+    stats.jitter = jitter_.Snapshot();
+    stats.step_time = step_time_.Snapshot();
+    return stats;
+  }
+
+  /**
+   * @brief Clear loop counters and timing histograms.
+   */
+  void ResetStats() {
+    cycles_.store(0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+    skipped_cycles_.store(0, std::memory_order_relaxed);
+    period_.Reset();
+    jitter_.Reset();
+    step_time_.Reset();
+  }
+
+ private:
+  static int64_t MonotonicNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+  }
+
+  static void* ThreadEntry(void* arg) {
+    static_cast<RtControlLoop*>(arg)->Run();
+    return nullptr;
+  }
+
+  // Wait for a thread that was stopped or requested to stop, called with control_mutex_ held
+  void Join() {
+    if (!joinable_) {
+      return;
+    }
+    pthread_join(thread_, nullptr);
+    joinable_ = false;
+    step_ = nullptr;
+  }
+
+  void Run() {
+    PrefaultStack();
+    const int64_t period = options_.period_ns;
+    int64_t deadline = MonotonicNs();
+    int64_t last_wakeup = 0;
+    RtCycleInfo info;
+    while (running_.load(std::memory_order_relaxed)) {
+      deadline += period;
+      timespec ts{};
+      ts.tv_sec = static_cast<time_t>(deadline / 1000000000);
+      ts.tv_nsec = static_cast<long>(deadline % 1000000000);
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+      }
+
+      int64_t wakeup = MonotonicNs();
+      jitter_.Record(static_cast<double>(wakeup - deadline));
+      if (last_wakeup != 0) {
+        period_.Record(static_cast<double>(wakeup - last_wakeup));
+      }
+      last_wakeup = wakeup;
+
+      info.deadline_ns = deadline;
+      info.wakeup_ns = wakeup;
+      step_(info);
+      info.cycle++;
+      cycles_.fetch_add(1, std::memory_order_relaxed);
+
+      int64_t finish = MonotonicNs();
+      step_time_.Record(static_cast<double>(finish - wakeup));
+      if (finish > deadline + period) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+        if (options_.skip_missed_cycles) {
+          int64_t missed = (finish - deadline) / period;
+          deadline += missed * period;
+          skipped_cycles_.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+  // Touch the stack once so page faults do not happen inside the loop
+  static void PrefaultStack() {
+    constexpr std::size_t kPrefaultSize = 64 * 1024;
+    [[maybe_unused]] volatile unsigned char buffer[kPrefaultSize];
+    for (std::size_t ii = 0; ii < kPrefaultSize; ii += 4096) {
+      buffer[ii] = 0;
+    }
+  }
+
+  const RtControlLoopOptions options_;
+  std::mutex control_mutex_;  // Serializes Start and Stop
+  std::atomic_bool running_{false};
+  bool joinable_ = false;  // Thread created and not joined yet, guarded by control_mutex_
+  pthread_t thread_{};
+  StepFunction step_;
+
+  std::atomic<uint64_t> cycles_{0};
+  std::atomic<uint64_t> overruns_{0};
+  std::atomic<uint64_t> skipped_cycles_{0};
+  Histogram period_;
+  Histogram jitter_;
+  Histogram step_time_;
+};
+
+}  // namespace magic::gen1
\ No newline at end of file
@@ -10,10 +10,25 @@
 #include "magic_type.h"
 
 #include "magic_audio.h"
+#include "magic_blackbox.h"
+#include "magic_cartesian_controller.h"
+#include "magic_dynamics.h"
+#include "magic_impedance_controller.h"
+#include "magic_joint_limiter.h"
+#include "magic_joint_statistics.h"
+#include "magic_kinematics.h"
+#include "magic_latency_probe.h"
 #include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_interpolator.h"
+#include "magic_motion_loopback.h"
+#include "magic_motion_state.h"
 #include "magic_sensor.h"
+#include "magic_shm_ring.h"
+#include "magic_shm_transport.h"
 #include "magic_slam_navigation.h"
 #include "magic_state_monitor.h"
+#include "magic_trajectory.h"
 
 namespace magic::gen1 {
 using namespace motion;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "magic_executor.h"
 #include "magic_export.h"
 #include "magic_type.h"
 
@@ -7,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace magic::gen1::sensor {
 
@@ -115,6 +117,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeLidarImu(const LidarImuCallback callback);
 
+  /**
+   * @brief Subscribe to LiDAR IMU data with dispatch options
+   * @param callback Processing callback after receiving LiDAR IMU data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeLidarImu(LidarImuCallback callback, const SubscriptionOptions& options) {
+    SubscribeLidarImu(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from LiDAR IMU data
    */
@@ -126,6 +137,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeLidarPointCloud(const LidarPointCloudCallback callback);
 
+  /**
+   * @brief Subscribe to LiDAR point cloud data with dispatch options
+   * @param callback Processing callback after receiving point cloud data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeLidarPointCloud(LidarPointCloudCallback callback, const SubscriptionOptions& options) {
+    SubscribeLidarPointCloud(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from LiDAR point cloud data
    */
@@ -137,6 +157,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeHeadRgbdColorImage(const RgbdImageCallback callback);
 
+  /**
+   * @brief Subscribe to head RGBD color image data with dispatch options
+   * @param callback Processing callback after receiving image data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHeadRgbdColorImage(RgbdImageCallback callback, const SubscriptionOptions& options) {
+    SubscribeHeadRgbdColorImage(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from head RGBD color image data
    */
@@ -148,6 +177,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeHeadRgbdColorCameraInfo(const RgbdCameraInfoCallback callback);
 
+  /**
+   * @brief Subscribe to head RGBD color camera parameter data with dispatch options
+   * @param callback Processing callback after receiving camera information
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHeadRgbdColorCameraInfo(RgbdCameraInfoCallback callback, const SubscriptionOptions& options) {
+    SubscribeHeadRgbdColorCameraInfo(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from head RGBD color camera parameter data
    */
@@ -159,6 +197,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeHeadRgbdDepthImage(const RgbdImageCallback callback);
 
+  /**
+   * @brief Subscribe to head RGBD depth image data with dispatch options
+   * @param callback Processing callback after receiving depth image data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHeadRgbdDepthImage(RgbdImageCallback callback, const SubscriptionOptions& options) {
+    SubscribeHeadRgbdDepthImage(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from head RGBD depth image data
    */
@@ -170,6 +217,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeHeadRgbdDepthCameraInfo(const RgbdCameraInfoCallback callback);
 
+  /**
+   * @brief Subscribe to head RGBD depth camera parameter data with dispatch options
+   * @param callback Processing callback after receiving depth camera information
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeHeadRgbdDepthCameraInfo(RgbdCameraInfoCallback callback, const SubscriptionOptions& options) {
+    SubscribeHeadRgbdDepthCameraInfo(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from head RGBD depth camera parameter data
    */
@@ -181,6 +237,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeWaistRgbdColorImage(const RgbdImageCallback callback);
 
+  /**
+   * @brief Subscribe to waist RGBD color image data with dispatch options
+   * @param callback Processing callback after receiving image data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWaistRgbdColorImage(RgbdImageCallback callback, const SubscriptionOptions& options) {
+    SubscribeWaistRgbdColorImage(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from waist RGBD color image data
    */
@@ -192,6 +257,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeWaistRgbdColorCameraInfo(const RgbdCameraInfoCallback callback);
 
+  /**
+   * @brief Subscribe to waist RGBD color camera parameter data with dispatch options
+   * @param callback Processing callback after receiving camera information
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWaistRgbdColorCameraInfo(RgbdCameraInfoCallback callback, const SubscriptionOptions& options) {
+    SubscribeWaistRgbdColorCameraInfo(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from waist RGBD color camera parameter data
    */
@@ -203,6 +277,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeWaistRgbdDepthImage(const RgbdImageCallback callback);
 
+  /**
+   * @brief Subscribe to waist RGBD depth image data with dispatch options
+   * @param callback Processing callback after receiving depth image data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWaistRgbdDepthImage(RgbdImageCallback callback, const SubscriptionOptions& options) {
+    SubscribeWaistRgbdDepthImage(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from waist RGBD depth image data
    */
@@ -214,6 +297,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeWaistRgbdDepthCameraInfo(const RgbdCameraInfoCallback callback);
 
+  /**
+   * @brief Subscribe to waist RGBD depth camera parameter data with dispatch options
+   * @param callback Processing callback after receiving depth camera information
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeWaistRgbdDepthCameraInfo(RgbdCameraInfoCallback callback, const SubscriptionOptions& options) {
+    SubscribeWaistRgbdDepthCameraInfo(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from waist RGBD depth camera parameter data
    */
@@ -225,6 +317,15 @@ class MAGIC_EXPORT_API SensorController final : public NonCopyable {
    */
   void SubscribeTrinocularImage(const TrinocularImageCallback callback);
 
+  /**
+   * @brief Subscribe to trinocular camera image frame data with dispatch options
+   * @param callback Processing callback after receiving trinocular camera data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeTrinocularImage(TrinocularImageCallback callback, const SubscriptionOptions& options) {
+    SubscribeTrinocularImage(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from trinocular camera image frame data
    */
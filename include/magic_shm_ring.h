@@ -0,0 +1,556 @@
+#pragma once
+
+#include "magic_type.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::transport {
+
+template <typename T>
+class ShmRing;
+template <typename T>
+using ShmRingPtr = std::unique_ptr<ShmRing<T>>;
+
+/**
+ * @brief Read position of one reader in a shared-memory ring
+ *
+ * Every reader keeps its own cursor, readers never affect each other or the writer.
+ */
+struct ShmCursor {
+  uint64_t next = 0;     ///< Sequence number of the next record to read
+  uint64_t read = 0;     ///< Records read
+  uint64_t lost = 0;     ///< Records overwritten by the writer before they were read
+  uint64_t skipped = 0;  ///< Records passed over on purpose with SkipToLatest
+  int32_t reader = -1;   ///< Entry in the reader table of the ring, -1 if not registered
+};
+
+/**
+ * @brief Progress of one registered reader, as seen from any process attached to the ring
+ */
+struct ShmReaderStats {
+  int32_t pid = 0;       ///< Process id of the reader
+  uint64_t lag = 0;      ///< Records written but not yet read or passed over
+  uint64_t read = 0;     ///< Records read
+  uint64_t lost = 0;     ///< Records overwritten before they were read
+  uint64_t skipped = 0;  ///< Records passed over on purpose
+};
+
+namespace detail {
+
+/**
+ * @brief Block until the futex word differs from the expected value, it is woken up or the timeout expires.
+ * @param word Futex word in shared memory.
+ * @param expected Value the word is expected to hold.
+ * @param timeout_ns Relative timeout (unit: nanoseconds), negative waits forever.
+ */
+inline void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, int64_t timeout_ns) {
+  timespec timeout{};
+  timeout.tv_sec = timeout_ns / 1000000000;
+  timeout.tv_nsec = timeout_ns % 1000000000;
+  // Not FUTEX_PRIVATE_FLAG, the word is shared between processes
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeout_ns < 0 ? nullptr : &timeout, nullptr, 0);
+}
+
+/**
+ * @brief Wake every thread blocked on the futex word, in any process.
+ * @param word Futex word in shared memory.
+ */
+inline void FutexWakeAll(std::atomic<uint32_t>* word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief POSIX shared-memory mapping, unlinked on destruction by the process that created it.
+ */
+class ShmRegion final : public NonCopyable {
+ public:
+  ShmRegion(std::string name, void* data, std::size_t size, bool owner) : name_(std::move(name)), data_(data), size_(size), owner_(owner) {}
+
+  ~ShmRegion() {
+    munmap(data_, size_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  /**
+   * @brief Create a zero-filled region, an existing region of the same name is left untouched.
+   * @return Mapped region, nullptr on failure; errno is EEXIST if a region of that name exists.
+   */
+  static std::unique_ptr<ShmRegion> Create(const std::string& name, std::size_t size) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+      return nullptr;
+    }
+    void* data = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+      data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+    return std::make_unique<ShmRegion>(name, data, size, true);
+  }
+
+  /**
+   * @brief Map an existing region.
+   * @return Mapped region, nullptr if it does not exist or cannot be mapped.
+   */
+  static std::unique_ptr<ShmRegion> Open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat info{};
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+      return nullptr;
+    }
+    return std::make_unique<ShmRegion>(name, data, static_cast<std::size_t>(info.st_size), false);
+  }
+
+  void* Data() const { return data_; }
+  std::size_t Size() const { return size_; }
+  bool Owner() const { return owner_; }
+
+ private:
+  const std::string name_;
+  void* const data_;
+  const std::size_t size_;
+  const bool owner_;
+};
+
+}  // namespace detail
+
+/**
+ * @class ShmRing
+ * @brief Single-writer, multi-reader broadcast ring of fixed-size records in POSIX shared memory.
+ *
+ * The writer claims the ring with ClaimWriter; while its process is alive no other writer, in any process, can claim
+ * it, so two producers can never interleave their writes into the same slot. The writer fills a record in place in
+ * the shared slot and never waits for readers: a slow reader loses the oldest records, counted in its cursor, instead
+ * of holding the writer back. Any number of readers in any number of processes read with their own cursor, each
+ * record is validated with a per-slot sequence number so a torn record is never returned. Readers can block on a
+ * futex in the ring header, the writer only enters the kernel when a reader is actually waiting.
+ *
+ * @tparam T Trivially copyable record type, e.g. JointStateT<Limb>, FixedHandState or Imu.
+ */
+template <typename T>
+class ShmRing final : public NonCopyable {
+  static_assert(std::is_trivially_copyable_v<T>, "ShmRing requires a trivially copyable record");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                "ShmRing requires address-free atomics");
+
+  static constexpr uint64_t kMagic = 0x4d41474943524e47;  // "MAGICRNG"
+  static constexpr uint32_t kVersion = 4;
+  static constexpr std::size_t kMaxReaders = 32;
+
+  // Cursor of one reader, published for monitoring
+  struct alignas(64) ReaderEntry {
+    std::atomic<int32_t> pid;  // 0 if free
+    std::atomic<uint64_t> next;
+    std::atomic<uint64_t> read;
+    std::atomic<uint64_t> lost;
+    std::atomic<uint64_t> skipped;
+  };
+
+  struct Header {
+    std::atomic<uint64_t> magic;   // Set last by the creator, the ring is complete once it holds kMagic
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    int32_t creator;               // Process id of the creating process
+    std::atomic<uint32_t> closed;  // Set once the creating process has destroyed the ring
+    alignas(64) std::atomic<uint64_t> writer;  // Token of the writer, process id in the upper half, 0 if free
+    alignas(64) std::atomic<uint64_t> head;    // Sequence number of the next record to write
+    alignas(64) std::atomic<uint32_t> futex;
+    std::atomic<uint32_t> waiters;
+    ReaderEntry readers[kMaxReaders];
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> seq;  // 2 * n + 1 while record n is written, 2 * n + 2 once it is complete
+    T value;
+  };
+
+ public:
+  /**
+   * @brief Create a ring. A ring of the same name is only replaced if the process that created it has exited.
+   * @param name Shared-memory object name, starting with '/'.
+   * @param capacity Number of slots, the history a reader may fall behind before it loses records.
+   * @return Ring, nullptr on failure or if a live process, or one of another SDK version, owns the name.
+   */
+  static ShmRingPtr<T> Create(const std::string& name, std::size_t capacity) {
+    capacity = std::max<std::size_t>(capacity, 2);
+    std::size_t size = sizeof(Header) + capacity * sizeof(Slot);
+    auto region = detail::ShmRegion::Create(name, size);
+    if (!region && errno == EEXIST && IsStale(name)) {
+      shm_unlink(name.c_str());
+      region = detail::ShmRegion::Create(name, size);
+    }
+    if (!region) {
+      return nullptr;
+    }
+    auto* header = static_cast<Header*>(region->Data());
+    header->version = kVersion;
+    header->record_size = sizeof(T);
+    header->capacity = capacity;
+    header->creator = static_cast<int32_t>(getpid());
+    header->magic.store(kMagic, std::memory_order_release);
+    return ShmRingPtr<T>(new ShmRing(std::move(region)));
+  }
+
+  /**
+   * @brief Attach to a ring created by another process.
+   * @param name Shared-memory object name, starting with '/'.
+   * @return Ring, nullptr if it does not exist, is not fully created or holds a different record type.
+   */
+  static ShmRingPtr<T> Open(const std::string& name) {
+    auto region = detail::ShmRegion::Open(name);
+    if (!region || region->Size() < sizeof(Header)) {
+      return nullptr;
+    }
+    auto* header = static_cast<Header*>(region->Data());
+    if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion ||
+        header->record_size != sizeof(T) || header->capacity <= 1 ||
+        header->capacity > (region->Size() - sizeof(Header)) / sizeof(Slot)) {
+      return nullptr;
+    }
+    return ShmRingPtr<T>(new ShmRing(std::move(region)));
+  }
+
+  /// Destructor, releases the write side if this ring object holds it and marks the ring closed in its creator.
+  ~ShmRing() {
+    ReleaseWriter();
+    if (region_->Owner()) {
+      header_->closed.store(1, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Whether the process that created the ring still serves it.
+   * @return False once the creator has destroyed the ring or exited. A ring created later under the same name is a
+   *         different ring, Open it again to attach to it.
+   */
+  bool IsOpen() const { return !IsClosed() && !(kill(header_->creator, 0) != 0 && errno == ESRCH); }
+
+  /**
+   * @brief Whether the creator has destroyed the ring, without the system call IsOpen uses to detect an exited creator.
+   */
+  bool IsClosed() const { return header_->closed.load(std::memory_order_acquire) != 0; }
+
+  /// Process id of the process that created the ring
+  int32_t Creator() const { return header_->creator; }
+
+  // === Writer ===
+
+  /**
+   * @brief Claim the write side of the ring for this ring object.
+   * @return False if another ring object, in this or another process, holds it. The claim of a process that has
+   *         exited is reclaimed.
+   * @note Must succeed before BeginWrite, EndWrite or Write are called.
+   */
+  bool ClaimWriter() {
+    if (writer_token_ != 0) {
+      return true;
+    }
+    static std::atomic<uint32_t> instances{0};
+    uint64_t token = (static_cast<uint64_t>(static_cast<uint32_t>(getpid())) << 32) | (instances.fetch_add(1, std::memory_order_relaxed) + 1);
+    uint64_t owner = header_->writer.load(std::memory_order_acquire);
+    while (true) {
+      auto owner_pid = static_cast<pid_t>(owner >> 32);
+      bool stale = owner != 0 && kill(owner_pid, 0) != 0 && errno == ESRCH;
+      if (owner != 0 && !stale) {
+        return false;
+      }
+      if (header_->writer.compare_exchange_weak(owner, token, std::memory_order_acq_rel)) {
+        writer_token_ = token;
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief Release the write side claimed with ClaimWriter.
+   */
+  void ReleaseWriter() {
+    if (writer_token_ == 0) {
+      return;
+    }
+    uint64_t token = writer_token_;
+    header_->writer.compare_exchange_strong(token, 0, std::memory_order_acq_rel);
+    writer_token_ = 0;
+  }
+
+  /**
+   * @brief Begin writing the next record in place, it must be fully written before EndWrite.
+   * @return Shared slot of the record, holding an older record.
+   * @note Only the ring object holding the write side (ClaimWriter), from one thread at a time, may write.
+   */
+  T& BeginWrite() {
+    uint64_t n = header_->head.load(std::memory_order_relaxed);
+    Slot& slot = slots_[n % capacity_];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return slot.value;
+  }
+
+  /**
+   * @brief Publish the record started with BeginWrite and wake the waiting readers.
+   */
+  void EndWrite() {
+    uint64_t n = header_->head.load(std::memory_order_relaxed);
+    slots_[n % capacity_].seq.store(2 * n + 2, std::memory_order_release);
+    header_->head.store(n + 1, std::memory_order_release);
+    header_->futex.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->waiters.load(std::memory_order_seq_cst) > 0) {
+      detail::FutexWakeAll(&header_->futex);
+    }
+  }
+
+  /**
+   * @brief Write one record.
+   * @param value Record.
+   */
+  void Write(const T& value) {
+    std::memcpy(static_cast<void*>(&BeginWrite()), static_cast<const void*>(&value), sizeof(T));
+    EndWrite();
+  }
+
+  // === Readers ===
+
+  /**
+   * @brief Cursor positioned after the newest record, so only records written from now on are read.
+   */
+  ShmCursor MakeCursor() const {
+    ShmCursor cursor;
+    cursor.next = header_->head.load(std::memory_order_acquire);
+    return cursor;
+  }
+
+  /**
+   * @brief Copy the next unread record.
+   * @param cursor Reader cursor, advanced past the record and any records lost to overwrites.
+   * @param[out] out Record.
+   * @return False if the reader has caught up with the writer.
+   */
+  bool Read(ShmCursor& cursor, T& out) const {
+    while (true) {
+      uint64_t head = header_->head.load(std::memory_order_acquire);
+      if (cursor.next >= head) {
+        return false;
+      }
+      // The slot after the oldest one may already be rewritten, keep one slot of margin
+      if (head - cursor.next >= capacity_) {
+        uint64_t oldest = head - capacity_ + 1;
+        cursor.lost += oldest - cursor.next;
+        cursor.next = oldest;
+      }
+      if (Copy(cursor.next, out)) {
+        cursor.next++;
+        cursor.read++;
+        return true;
+      }
+      cursor.lost++;
+      cursor.next++;
+    }
+  }
+
+  /**
+   * @brief Copy the newest record, skipping everything in between.
+   * @param[out] out Record.
+   * @return False if nothing has been written yet.
+   */
+  bool ReadLatest(T& out) const {
+    while (true) {
+      uint64_t head = header_->head.load(std::memory_order_acquire);
+      if (head == 0) {
+        return false;
+      }
+      if (Copy(head - 1, out)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief Pass over every unread record but the newest one, for readers that only need the latest value.
+   * @param cursor Reader cursor, the records passed over are counted as skipped.
+   */
+  void SkipToLatest(ShmCursor& cursor) const {
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    if (head > cursor.next + 1) {
+      cursor.skipped += head - 1 - cursor.next;
+      cursor.next = head - 1;
+    }
+  }
+
+  /**
+   * @brief Block until a record the cursor has not read is available.
+   * @param cursor Reader cursor.
+   * @param timeout_ns Maximum wait (unit: nanoseconds), negative waits forever.
+   * @return Whether an unread record is available.
+   */
+  bool Wait(const ShmCursor& cursor, int64_t timeout_ns) const {
+    uint32_t word = header_->futex.load(std::memory_order_seq_cst);
+    if (header_->head.load(std::memory_order_acquire) > cursor.next) {
+      return true;
+    }
+    header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+    detail::FutexWait(&header_->futex, word, timeout_ns);
+    header_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return header_->head.load(std::memory_order_acquire) > cursor.next;
+  }
+
+  /**
+   * @brief Wake every reader blocked in Wait, e.g. before shutting down.
+   */
+  void WakeAll() const {
+    header_->futex.fetch_add(1, std::memory_order_seq_cst);
+    detail::FutexWakeAll(&header_->futex);
+  }
+
+  // === Reader Table ===
+
+  /**
+   * @brief Claim an entry in the reader table, so the cursor is visible to GetReaderStats in every process.
+   * @param cursor Reader cursor, remembers the entry.
+   * @return False if all kMaxReaders entries are taken, the cursor still works but is not listed.
+   * @note Entries of readers whose process has exited are reclaimed.
+   */
+  bool RegisterReader(ShmCursor& cursor) const {
+    int32_t self = static_cast<int32_t>(getpid());
+    for (std::size_t ii = 0; ii < kMaxReaders; ii++) {
+      ReaderEntry& entry = header_->readers[ii];
+      int32_t owner = entry.pid.load(std::memory_order_acquire);
+      bool stale = owner != 0 && kill(owner, 0) != 0 && errno == ESRCH;
+      if ((owner == 0 || stale) && entry.pid.compare_exchange_strong(owner, self, std::memory_order_acq_rel)) {
+        cursor.reader = static_cast<int32_t>(ii);
+        PublishCursor(cursor);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Publish the cursor to its reader table entry, cheap enough to call after every read.
+   * @param cursor Registered reader cursor.
+   */
+  void PublishCursor(const ShmCursor& cursor) const {
+    if (cursor.reader < 0) {
+      return;
+    }
+    ReaderEntry& entry = header_->readers[cursor.reader];
+    entry.next.store(cursor.next, std::memory_order_relaxed);
+    entry.read.store(cursor.read, std::memory_order_relaxed);
+    entry.lost.store(cursor.lost, std::memory_order_relaxed);
+    entry.skipped.store(cursor.skipped, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Release the reader table entry of the cursor.
+   * @param cursor Registered reader cursor.
+   */
+  void UnregisterReader(ShmCursor& cursor) const {
+    if (cursor.reader < 0) {
+      return;
+    }
+    header_->readers[cursor.reader].pid.store(0, std::memory_order_release);
+    cursor.reader = -1;
+  }
+
+  /**
+   * @brief Get the progress of every registered reader.
+   */
+  std::vector<ShmReaderStats> GetReaderStats() const {
+    std::vector<ShmReaderStats> readers;
+    uint64_t head = header_->head.load(std::memory_order_acquire);
+    for (const ReaderEntry& entry : header_->readers) {
+      ShmReaderStats stats;
+      stats.pid = entry.pid.load(std::memory_order_acquire);
+      if (stats.pid == 0) {
+        continue;
+      }
+      uint64_t next = entry.next.load(std::memory_order_relaxed);
+      stats.lag = head > next ? head - next : 0;
+      stats.read = entry.read.load(std::memory_order_relaxed);
+      stats.lost = entry.lost.load(std::memory_order_relaxed);
+      stats.skipped = entry.skipped.load(std::memory_order_relaxed);
+      readers.push_back(stats);
+    }
+    return readers;
+  }
+
+  /// Records written since the ring was created
+  uint64_t Written() const { return header_->head.load(std::memory_order_acquire); }
+
+  /// Number of slots
+  std::size_t Capacity() const { return capacity_; }
+
+ private:
+  explicit ShmRing(std::unique_ptr<detail::ShmRegion> region)
+      : region_(std::move(region)),
+        header_(static_cast<Header*>(region_->Data())),
+        slots_(reinterpret_cast<Slot*>(static_cast<char*>(region_->Data()) + sizeof(Header))),
+        capacity_(header_->capacity) {}
+
+  // Whether the existing ring of that name was left behind by a process that exited without removing it
+  static bool IsStale(const std::string& name) {
+    auto region = detail::ShmRegion::Open(name);
+    if (!region || region->Size() < sizeof(Header)) {
+      return false;  // removed meanwhile, or still being created
+    }
+    auto* header = static_cast<Header*>(region->Data());
+    // A ring still being created, or one of another layout whose creator cannot be checked, is left alone
+    if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion) {
+      return false;
+    }
+    return kill(header->creator, 0) != 0 && errno == ESRCH;
+  }
+
+  // Copy record n, false if the slot no longer holds it
+  bool Copy(uint64_t n, T& out) const {
+    const Slot& slot = slots_[n % capacity_];
+    uint64_t expected = 2 * n + 2;
+    if (slot.seq.load(std::memory_order_acquire) != expected) {
+      return false;
+    }
+    std::memcpy(static_cast<void*>(&out), static_cast<const void*>(&slot.value), sizeof(T));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == expected;
+  }
+
+  std::unique_ptr<detail::ShmRegion> region_;
+  Header* const header_;
+  Slot* const slots_;
+  const std::size_t capacity_;
+  uint64_t writer_token_ = 0;  // Token stored in the header while this object holds the write side
+};
+
+}  // namespace magic::gen1::transport
@@ -0,0 +1,712 @@
+#pragma once
+
+#include "magic_motion_command.h"
+#include "magic_motion_state.h"
+#include "magic_realtime.h"
+#include "magic_shm_ring.h"
+#include "magic_type.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::transport {
+
+class ShmTransportServer;
+using ShmTransportServerPtr = std::unique_ptr<ShmTransportServer>;
+
+class ShmTransportClient;
+using ShmTransportClientPtr = std::unique_ptr<ShmTransportClient>;
+
+/**
+ * @brief Shared-memory transport configuration, server and clients must use the same prefix
+ */
+struct ShmTransportOptions {
+  std::string prefix = "/magicbot_gen1";  ///< Prefix of the shared-memory object names, starting with '/'
+  std::size_t capacity = 64;              ///< Slots per ring, the history a reader may fall behind before it loses records
+  int priority = 0;                       ///< SCHED_FIFO priority [1, 99] of the transport threads, 0 keeps the default scheduler
+  int cpu = -1;                           ///< CPU core the transport threads are pinned to, -1 means no pinning
+};
+
+/**
+ * @brief How a subscription copes with records arriving faster than its callback handles them
+ */
+enum class ShmBackpressure : int8_t {
+  DROP_OLDEST = 0,  ///< Deliver every record in order, records overwritten before they are read are lost
+  LATEST_ONLY = 1,  ///< Deliver only the newest record at every wakeup, older unread records are skipped
+};
+
+/**
+ * @brief Shared-memory transport counters of one ring
+ */
+struct ShmTopicStats {
+  uint64_t written = 0;  ///< Records written by the ring writer
+  uint64_t read = 0;     ///< Records read by this process
+  uint64_t lost = 0;     ///< Records this process fell too far behind to read
+  uint64_t skipped = 0;  ///< Records passed over by a LATEST_ONLY subscription
+};
+
+/**
+ * @brief Progress of one client reading a topic exported by the server
+ */
+struct ShmClientStats {
+  std::string topic;      ///< Topic, e.g. "arm_state"
+  ShmReaderStats reader;  ///< Read cursor of the client
+};
+
+namespace detail {
+
+/// Poll interval of the transport threads for shutdown (unit: nanoseconds)
+inline constexpr int64_t kShmWaitTimeoutNs = 100000000;
+
+/// Shared-memory object names of the transported topics
+struct ShmTopicNames {
+  static std::string ArmState(const std::string& prefix) { return prefix + ".arm_state"; }
+  static std::string LegState(const std::string& prefix) { return prefix + ".leg_state"; }
+  static std::string HeadState(const std::string& prefix) { return prefix + ".head_state"; }
+  static std::string WaistState(const std::string& prefix) { return prefix + ".waist_state"; }
+  static std::string HandState(const std::string& prefix) { return prefix + ".hand_state"; }
+  static std::string BodyImu(const std::string& prefix) { return prefix + ".body_imu"; }
+  static std::string ArmCommand(const std::string& prefix) { return prefix + ".arm_cmd"; }
+  static std::string LegCommand(const std::string& prefix) { return prefix + ".leg_cmd"; }
+  static std::string HeadCommand(const std::string& prefix) { return prefix + ".head_cmd"; }
+  static std::string WaistCommand(const std::string& prefix) { return prefix + ".waist_cmd"; }
+  static std::string HandCommand(const std::string& prefix) { return prefix + ".hand_cmd"; }
+};
+
+/// Append the reader table of one ring to the client statistics
+template <typename T>
+void AppendClientStats(std::vector<ShmClientStats>& stats, const char* topic, const ShmRingPtr<T>& ring) {
+  if (!ring) {
+    return;
+  }
+  for (const ShmReaderStats& reader : ring->GetReaderStats()) {
+    stats.push_back({topic, reader});
+  }
+}
+
+/**
+ * @brief Thread draining one shared-memory ring into a handler until stopped.
+ */
+template <typename T>
+class ShmRingReaderThread final : public NonCopyable {
+ public:
+  using Handler = std::function<void(const T&)>;
+
+  ShmRingReaderThread(ShmRingPtr<T> ring, Handler handler, ShmBackpressure backpressure)
+      : ring_(std::move(ring)), handler_(std::move(handler)), backpressure_(backpressure), cursor_(ring_->MakeCursor()) {
+    ring_->RegisterReader(cursor_);
+  }
+
+  ~ShmRingReaderThread() {
+    Stop();
+    ring_->UnregisterReader(cursor_);
+  }
+
+  int Start(int priority, int cpu, const std::string& name) {
+    running_.store(true);
+    int ret = gen1::detail::CreateThread(thread_, &ShmRingReaderThread::ThreadEntry, this, priority, cpu, name);
+    if (ret != 0) {
+      running_.store(false);
+    }
+    started_ = ret == 0;
+    return ret;
+  }
+
+  void Stop() {
+    if (!started_) {
+      return;
+    }
+    running_.store(false);
+    ring_->WakeAll();
+    pthread_join(thread_, nullptr);
+    started_ = false;
+  }
+
+  ShmTopicStats GetStats() const {
+    ShmTopicStats stats;
+    stats.written = ring_->Written();
+    stats.read = read_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    stats.skipped = skipped_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  static void* ThreadEntry(void* arg) {
+    static_cast<ShmRingReaderThread*>(arg)->Run();
+    return nullptr;
+  }
+
+  void Run() {
+    T record;
+    while (running_.load()) {
+      if (!ring_->Wait(cursor_, kShmWaitTimeoutNs)) {
+        continue;
+      }
+      if (backpressure_ == ShmBackpressure::LATEST_ONLY) {
+        ring_->SkipToLatest(cursor_);
+        if (ring_->Read(cursor_, record)) {
+          handler_(record);
+        }
+      } else {
+        while (ring_->Read(cursor_, record)) {
+          handler_(record);
+        }
+      }
+      ring_->PublishCursor(cursor_);
+      read_.store(cursor_.read, std::memory_order_relaxed);
+      lost_.store(cursor_.lost, std::memory_order_relaxed);
+      skipped_.store(cursor_.skipped, std::memory_order_relaxed);
+    }
+  }
+
+  ShmRingPtr<T> ring_;
+  Handler handler_;
+  const ShmBackpressure backpressure_;
+  ShmCursor cursor_;
+  pthread_t thread_{};
+  bool started_ = false;
+  std::atomic_bool running_{false};
+  std::atomic<uint64_t> read_{0};
+  std::atomic<uint64_t> lost_{0};
+  std::atomic<uint64_t> skipped_{0};
+};
+
+}  // namespace detail
+
+/**
+ * @class ShmTransportServer
+ * @brief Exports the low-level state and command path of this process to other processes on the same host.
+ *
+ * Runs in the process owning the robot connection. Every joint, hand and body IMU state received by the
+ * LowLevelStateHub is written once into a shared-memory ring, where any number of ShmTransportClient processes read
+ * it in place, without going through the network stack. Commands written by clients are picked up by one thread per
+ * body part and published through the LowLevelCommandPublisher, so its stages and statistics apply; a command still
+ * pending when a newer one arrives is skipped.
+ */
+class ShmTransportServer final : public NonCopyable {
+  using JointStatePtr = std::shared_ptr<JointState>;  // Joint state message pointer
+  using ImuPtr = std::shared_ptr<Imu>;                // IMU inertial measurement unit message pointer
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param hub State hub whose messages are exported, must be initialized by the caller.
+   * @param publisher Publisher sending the commands of the clients.
+   * @param options Object names, ring size and thread attributes.
+   */
+  ShmTransportServer(motion::LowLevelStateHub& hub, motion::LowLevelCommandPublisher& publisher, const ShmTransportOptions& options = {})
+      : hub_(hub), publisher_(publisher), options_(options) {}
+
+  /// Destructor, stops the transport and removes the shared-memory objects.
+  ~ShmTransportServer() { Shutdown(); }
+
+  /**
+   * @brief Create the shared-memory rings and start exporting.
+   * @return Execution status, fails if a ring or a command thread cannot be created.
+   */
+  Status Initialize() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (!listener_ids_.empty()) {
+      return {ErrorCode::OK, ""};
+    }
+    using Names = detail::ShmTopicNames;
+    const std::string& prefix = options_.prefix;
+    arm_state_ = ShmRing<ArmJointState>::Create(Names::ArmState(prefix), options_.capacity);
+    leg_state_ = ShmRing<LegJointState>::Create(Names::LegState(prefix), options_.capacity);
+    head_state_ = ShmRing<HeadJointState>::Create(Names::HeadState(prefix), options_.capacity);
+    waist_state_ = ShmRing<WaistJointState>::Create(Names::WaistState(prefix), options_.capacity);
+    hand_state_ = ShmRing<FixedHandState>::Create(Names::HandState(prefix), options_.capacity);
+    body_imu_ = ShmRing<Imu>::Create(Names::BodyImu(prefix), options_.capacity);
+    if (!arm_state_ || !leg_state_ || !head_state_ || !waist_state_ || !hand_state_ || !body_imu_ || !arm_state_->ClaimWriter() ||
+        !leg_state_->ClaimWriter() || !head_state_->ClaimWriter() || !waist_state_->ClaimWriter() || !hand_state_->ClaimWriter() ||
+        !body_imu_->ClaimWriter()) {
+      ReleaseRings();
+      return {ErrorCode::INTERNAL_ERROR, "failed to create shared-memory state rings, another server may be running with this prefix"};
+    }
+
+    Status status = StartCommandThread<ArmJointCommand>(arm_command_, Names::ArmCommand(prefix), [this](const ArmJointCommand& command) { publisher_.PublishArmCommand(command); });
+    if (status.code == ErrorCode::OK) {
+      status = StartCommandThread<LegJointCommand>(leg_command_, Names::LegCommand(prefix), [this](const LegJointCommand& command) { publisher_.PublishLegCommand(command); });
+    }
+    if (status.code == ErrorCode::OK) {
+      status = StartCommandThread<HeadJointCommand>(head_command_, Names::HeadCommand(prefix), [this](const HeadJointCommand& command) { publisher_.PublishHeadCommand(command); });
+    }
+    if (status.code == ErrorCode::OK) {
+      status = StartCommandThread<WaistJointCommand>(waist_command_, Names::WaistCommand(prefix), [this](const WaistJointCommand& command) { publisher_.PublishWaistCommand(command); });
+    }
+    if (status.code == ErrorCode::OK) {
+      status = StartCommandThread<FixedHandCommand>(hand_command_, Names::HandCommand(prefix), [this](const FixedHandCommand& command) { publisher_.PublishHandCommand(command); });
+    }
+    if (status.code != ErrorCode::OK) {
+      StopCommandThreads();
+      ReleaseRings();
+      return status;
+    }
+
+    listener_ids_.push_back(hub_.AddJointStateListener([this](BodyPartMask part, const JointStatePtr& msg) { OnJointState(part, *msg); }));
+    listener_ids_.push_back(hub_.AddFixedHandStateListener([this](const FixedHandState& state) { hand_state_->Write(state); }));
+    listener_ids_.push_back(hub_.AddBodyImuListener([this](const ImuPtr& msg) { body_imu_->Write(*msg); }));
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Stop exporting and remove the shared-memory objects, attached clients stop receiving data.
+   */
+  void Shutdown() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (listener_ids_.empty()) {
+      return;
+    }
+    for (uint64_t id : listener_ids_) {
+      hub_.RemoveListener(id);
+    }
+    listener_ids_.clear();
+    StopCommandThreads();
+    ReleaseRings();
+  }
+
+  /**
+   * @brief Get the read cursor of every client subscribed to the exported state topics.
+   * @return One entry per client subscription, clients that exited are dropped once their entry is reused.
+   */
+  std::vector<ShmClientStats> GetClientStats() const {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    std::vector<ShmClientStats> stats;
+    detail::AppendClientStats(stats, "arm_state", arm_state_);
+    detail::AppendClientStats(stats, "leg_state", leg_state_);
+    detail::AppendClientStats(stats, "head_state", head_state_);
+    detail::AppendClientStats(stats, "waist_state", waist_state_);
+    detail::AppendClientStats(stats, "hand_state", hand_state_);
+    detail::AppendClientStats(stats, "body_imu", body_imu_);
+    return stats;
+  }
+
+ private:
+  void OnJointState(BodyPartMask part, const JointState& msg) {
+    switch (part) {
+      case kBodyPartArm:
+        WriteJointState(*arm_state_, msg);
+        break;
+      case kBodyPartLeg:
+        WriteJointState(*leg_state_, msg);
+        break;
+      case kBodyPartHead:
+        WriteJointState(*head_state_, msg);
+        break;
+      case kBodyPartWaist:
+        WriteJointState(*waist_state_, msg);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // Copied straight from the received message into the shared slot
+  template <typename Limb>
+  static void WriteJointState(ShmRing<JointStateT<Limb>>& ring, const JointState& msg) {
+    auto& record = ring.BeginWrite();
+    record.timestamp = msg.timestamp;
+    std::size_t count = std::min(msg.joints.size(), Limb::kJointNum);
+    std::copy_n(msg.joints.begin(), count, record.joints.begin());
+    std::fill(record.joints.begin() + count, record.joints.end(), SingleJointState{});
+    ring.EndWrite();
+  }
+
+  template <typename Command, typename Handler>
+  Status StartCommandThread(std::unique_ptr<detail::ShmRingReaderThread<Command>>& thread, const std::string& name, Handler&& handler) {
+    auto ring = ShmRing<Command>::Create(name, options_.capacity);
+    if (!ring) {
+      return {ErrorCode::INTERNAL_ERROR, "failed to create shared-memory command ring " + name + ", another server may be running with this prefix"};
+    }
+    thread = std::make_unique<detail::ShmRingReaderThread<Command>>(std::move(ring), std::forward<Handler>(handler), ShmBackpressure::LATEST_ONLY);
+    int ret = thread->Start(options_.priority, options_.cpu, "magic_shm_cmd");
+    if (ret != 0) {
+      thread.reset();
+      return {ErrorCode::INTERNAL_ERROR, std::string("failed to create command thread: ") + std::strerror(ret)};
+    }
+    return {ErrorCode::OK, ""};
+  }
+
+  void StopCommandThreads() {
+    arm_command_.reset();
+    leg_command_.reset();
+    head_command_.reset();
+    waist_command_.reset();
+    hand_command_.reset();
+  }
+
+  void ReleaseRings() {
+    arm_state_.reset();
+    leg_state_.reset();
+    head_state_.reset();
+    waist_state_.reset();
+    hand_state_.reset();
+    body_imu_.reset();
+  }
+
+  motion::LowLevelStateHub& hub_;
+  motion::LowLevelCommandPublisher& publisher_;
+  const ShmTransportOptions options_;
+
+  mutable std::mutex control_mutex_;  // Serializes Initialize, Shutdown and GetClientStats
+  std::vector<uint64_t> listener_ids_;
+
+  ShmRingPtr<ArmJointState> arm_state_;
+  ShmRingPtr<LegJointState> leg_state_;
+  ShmRingPtr<HeadJointState> head_state_;
+  ShmRingPtr<WaistJointState> waist_state_;
+  ShmRingPtr<FixedHandState> hand_state_;
+  ShmRingPtr<Imu> body_imu_;
+
+  std::unique_ptr<detail::ShmRingReaderThread<ArmJointCommand>> arm_command_;
+  std::unique_ptr<detail::ShmRingReaderThread<LegJointCommand>> leg_command_;
+  std::unique_ptr<detail::ShmRingReaderThread<HeadJointCommand>> head_command_;
+  std::unique_ptr<detail::ShmRingReaderThread<WaistJointCommand>> waist_command_;
+  std::unique_ptr<detail::ShmRingReaderThread<FixedHandCommand>> hand_command_;
+};
+
+/**
+ * @class ShmTransportClient
+ * @brief Low-level state subscriptions and command publishing through the shared memory of a ShmTransportServer.
+ *
+ * For processes on the robot's compute board that do not hold their own robot connection. Offers the fixed-size
+ * Subscribe*, GetLatest* and Publish* interfaces of the low-level path. Each subscription reads its ring on its own
+ * thread, blocking on a futex while there is no new data, with its own read cursor and backpressure policy; the
+ * server never waits for a slow client. The first client to publish to a body part owns its command ring until it
+ * shuts down or exits; publishing to that body part from any other client fails with SERVICE_ERROR. Once the server
+ * has stopped, publishing fails with SERVICE_NOT_READY and IsConnected returns false, also if a new server has been
+ * started under the same prefix. A server that exited without shutting down is detected by publishing within
+ * 100 milliseconds.
+ *
+ * Publish*, GetLatest* and Subscribe* may be called from any thread between Initialize and Shutdown. Publish* and
+ * GetLatest* must not overlap Initialize or Shutdown, which replace the rings they use without locking.
+ */
+class ShmTransportClient final : public NonCopyable {
+ public:
+  template <typename T>
+  using Callback = std::function<void(const T&)>;  // Subscription callback, the record is only valid during the call
+
+  /**
+   * @brief Constructor.
+   * @param options Object names and subscription thread attributes, the prefix must match the server.
+   */
+  explicit ShmTransportClient(const ShmTransportOptions& options = {}) : options_(options) {}
+
+  /// Destructor, stops the subscription threads.
+  ~ShmTransportClient() { Shutdown(); }
+
+  /**
+   * @brief Attach to the shared-memory rings of the server.
+   * @return Whether initialization was successful, fails if the server is not running or restarted while attaching.
+   */
+  bool Initialize() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (arm_state_) {
+      return true;
+    }
+    using Names = detail::ShmTopicNames;
+    const std::string& prefix = options_.prefix;
+    arm_state_ = ShmRing<ArmJointState>::Open(Names::ArmState(prefix));
+    leg_state_ = ShmRing<LegJointState>::Open(Names::LegState(prefix));
+    head_state_ = ShmRing<HeadJointState>::Open(Names::HeadState(prefix));
+    waist_state_ = ShmRing<WaistJointState>::Open(Names::WaistState(prefix));
+    hand_state_ = ShmRing<FixedHandState>::Open(Names::HandState(prefix));
+    body_imu_ = ShmRing<Imu>::Open(Names::BodyImu(prefix));
+    arm_command_ = ShmRing<ArmJointCommand>::Open(Names::ArmCommand(prefix));
+    leg_command_ = ShmRing<LegJointCommand>::Open(Names::LegCommand(prefix));
+    head_command_ = ShmRing<HeadJointCommand>::Open(Names::HeadCommand(prefix));
+    waist_command_ = ShmRing<WaistJointCommand>::Open(Names::WaistCommand(prefix));
+    hand_command_ = ShmRing<FixedHandCommand>::Open(Names::HandCommand(prefix));
+    if (!arm_state_ || !leg_state_ || !head_state_ || !waist_state_ || !hand_state_ || !body_imu_ ||
+        !arm_command_ || !leg_command_ || !head_command_ || !waist_command_ || !hand_command_) {
+      ReleaseRings();
+      return false;
+    }
+    // Every ring must come from the same, running server
+    int32_t server = arm_state_->Creator();
+    if (!arm_state_->IsOpen() || leg_state_->Creator() != server || head_state_->Creator() != server ||
+        waist_state_->Creator() != server || hand_state_->Creator() != server || body_imu_->Creator() != server ||
+        arm_command_->Creator() != server || leg_command_->Creator() != server || head_command_->Creator() != server ||
+        waist_command_->Creator() != server || hand_command_->Creator() != server) {
+      ReleaseRings();
+      return false;
+    }
+    server_alive_.store(true, std::memory_order_relaxed);
+    next_liveness_ns_.store(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Whether the server this client attached to is still running.
+   * @return False once the server has shut down or exited; Shutdown and Initialize again to attach to a new server.
+   */
+  bool IsConnected() const { return arm_state_ && arm_state_->IsOpen(); }
+
+  /**
+   * @brief Stop all subscriptions and detach from the server.
+   */
+  void Shutdown() {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    subscriptions_.clear();
+    ReleaseRings();
+  }
+
+  // === Subscriptions ===
+
+  /**
+   * @brief Subscribe to arm joint states.
+   * @param callback Called on the subscription thread for every state delivered.
+   * @param backpressure Handling of states arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeArmState(Callback<ArmJointState> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::ArmState(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Subscribe to leg joint states.
+   * @param callback Called on the subscription thread for every state delivered.
+   * @param backpressure Handling of states arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeLegState(Callback<LegJointState> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::LegState(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Subscribe to head joint states.
+   * @param callback Called on the subscription thread for every state delivered.
+   * @param backpressure Handling of states arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeHeadState(Callback<HeadJointState> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::HeadState(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Subscribe to waist joint states.
+   * @param callback Called on the subscription thread for every state delivered.
+   * @param backpressure Handling of states arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeWaistState(Callback<WaistJointState> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::WaistState(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Subscribe to hand states.
+   * @param callback Called on the subscription thread for every state delivered.
+   * @param backpressure Handling of states arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeHandState(Callback<FixedHandState> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::HandState(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Subscribe to body IMU data.
+   * @param callback Called on the subscription thread for every sample delivered.
+   * @param backpressure Handling of samples arriving faster than the callback returns.
+   * @return Whether the subscription thread was started.
+   */
+  bool SubscribeBodyImu(Callback<Imu> callback, ShmBackpressure backpressure = ShmBackpressure::DROP_OLDEST) {
+    return Subscribe(detail::ShmTopicNames::BodyImu(options_.prefix), std::move(callback), backpressure);
+  }
+
+  /**
+   * @brief Get counters of every subscription, in subscription order.
+   */
+  std::vector<ShmTopicStats> GetSubscriptionStats() const {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    std::vector<ShmTopicStats> stats;
+    for (const auto& subscription : subscriptions_) {
+      stats.push_back(subscription.stats());
+    }
+    return stats;
+  }
+
+  // === Latest State Polling ===
+
+  /**
+   * @brief Copy the latest arm joint state, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestArmState(ArmJointState& state) const { return arm_state_ && arm_state_->ReadLatest(state); }
+
+  /**
+   * @brief Copy the latest leg joint state, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestLegState(LegJointState& state) const { return leg_state_ && leg_state_->ReadLatest(state); }
+
+  /**
+   * @brief Copy the latest head joint state, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestHeadState(HeadJointState& state) const { return head_state_ && head_state_->ReadLatest(state); }
+
+  /**
+   * @brief Copy the latest waist joint state, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestWaistState(WaistJointState& state) const { return waist_state_ && waist_state_->ReadLatest(state); }
+
+  /**
+   * @brief Copy the latest hand state, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestHandState(FixedHandState& state) const { return hand_state_ && hand_state_->ReadLatest(state); }
+
+  /**
+   * @brief Copy the latest body IMU sample, never blocks the server.
+   * @return False if nothing was received yet.
+   */
+  bool GetLatestBodyImu(Imu& imu) const { return body_imu_ && body_imu_->ReadLatest(imu); }
+
+  // === Commands ===
+
+  /**
+   * @brief Publish arm joint control command
+   * @param command Arm joint control command
+   * @return Execution status, OK once the command is in shared memory, SERVICE_ERROR if another client publishes to
+   *         the arms.
+   */
+  Status PublishArmCommand(const ArmJointCommand& command) { return Write(arm_command_, command); }
+
+  /**
+   * @brief Publish leg joint control command
+   * @param command Leg joint control command
+   * @return Execution status, OK once the command is in shared memory, SERVICE_ERROR if another client publishes to
+   *         the legs.
+   */
+  Status PublishLegCommand(const LegJointCommand& command) { return Write(leg_command_, command); }
+
+  /**
+   * @brief Publish head joint control command
+   * @param command Head joint control command
+   * @return Execution status, OK once the command is in shared memory, SERVICE_ERROR if another client publishes to
+   *         the head.
+   */
+  Status PublishHeadCommand(const HeadJointCommand& command) { return Write(head_command_, command); }
+
+  /**
+   * @brief Publish waist joint control command
+   * @param command Waist joint control command
+   * @return Execution status, OK once the command is in shared memory, SERVICE_ERROR if another client publishes to
+   *         the waist.
+   */
+  Status PublishWaistCommand(const WaistJointCommand& command) { return Write(waist_command_, command); }
+
+  /**
+   * @brief Publish hand control command
+   * @param command Hand control command for both hands
+   * @return Execution status, OK once the command is in shared memory, SERVICE_ERROR if another client publishes to
+   *         the hands.
+   */
+  Status PublishHandCommand(const FixedHandCommand& command) { return Write(hand_command_, command); }
+
+ private:
+  // Type-erased subscription thread
+  struct Subscription {
+    std::shared_ptr<void> thread;
+    std::function<ShmTopicStats()> stats;
+  };
+
+  template <typename T>
+  bool Subscribe(const std::string& name, Callback<T> callback, ShmBackpressure backpressure) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+    if (!arm_state_ || !callback) {
+      return false;
+    }
+    // Every subscription has its own mapping and cursor
+    auto ring = ShmRing<T>::Open(name);
+    if (!ring) {
+      return false;
+    }
+    auto thread = std::make_shared<detail::ShmRingReaderThread<T>>(std::move(ring), std::move(callback), backpressure);
+    if (thread->Start(options_.priority, options_.cpu, "magic_shm_sub") != 0) {
+      return false;
+    }
+    subscriptions_.push_back({thread, [thread] { return thread->GetStats(); }});
+    return true;
+  }
+
+  // The write side is claimed on the first publish, so clients that only subscribe never hold it
+  template <typename Command>
+  Status Write(const ShmRingPtr<Command>& ring, const Command& command) {
+    if (!ring) {
+      return {ErrorCode::SERVICE_ERROR, "shared-memory transport not initialized"};
+    }
+    if (!ServerAlive(*ring)) {
+      return {ErrorCode::SERVICE_NOT_READY, "shared-memory transport server has stopped"};
+    }
+    if (!ring->ClaimWriter()) {
+      return {ErrorCode::SERVICE_ERROR, "another client is publishing to this body part"};
+    }
+    ring->Write(command);
+    return {ErrorCode::OK, ""};
+  }
+
+  // The closed flag is checked on every publish, the system call probing for an exited server only once per interval
+  template <typename T>
+  bool ServerAlive(const ShmRing<T>& ring) {
+    if (ring.IsClosed() || !server_alive_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    int64_t now = motion::detail::SteadyNowNs();
+    int64_t next = next_liveness_ns_.load(std::memory_order_relaxed);
+    if (now >= next && next_liveness_ns_.compare_exchange_strong(next, now + kLivenessIntervalNs, std::memory_order_relaxed) && !ring.IsOpen()) {
+      server_alive_.store(false, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  void ReleaseRings() {
+    arm_state_.reset();
+    leg_state_.reset();
+    head_state_.reset();
+    waist_state_.reset();
+    hand_state_.reset();
+    body_imu_.reset();
+    arm_command_.reset();
+    leg_command_.reset();
+    head_command_.reset();
+    waist_command_.reset();
+    hand_command_.reset();
+  }
+
+  static constexpr int64_t kLivenessIntervalNs = 100000000;  // Publish probes for an exited server at most this often
+
+  const ShmTransportOptions options_;
+  mutable std::mutex control_mutex_;  // Guards the subscriptions, serializes Initialize and Shutdown
+  std::vector<Subscription> subscriptions_;
+  std::atomic_bool server_alive_{false};      // Cleared once a publish found the server gone
+  std::atomic<int64_t> next_liveness_ns_{0};  // Steady time of the next server probe on the publish path
+
+  ShmRingPtr<ArmJointState> arm_state_;
+  ShmRingPtr<LegJointState> leg_state_;
+  ShmRingPtr<HeadJointState> head_state_;
+  ShmRingPtr<WaistJointState> waist_state_;
+  ShmRingPtr<FixedHandState> hand_state_;
+  ShmRingPtr<Imu> body_imu_;
+  ShmRingPtr<ArmJointCommand> arm_command_;
+  ShmRingPtr<LegJointCommand> leg_command_;
+  ShmRingPtr<HeadJointCommand> head_command_;
+  ShmRingPtr<WaistJointCommand> waist_command_;
+  ShmRingPtr<FixedHandCommand> hand_command_;
+};
+
+}  // namespace magic::gen1::transport
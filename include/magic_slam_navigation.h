@@ -1,5 +1,6 @@
 #pragma once
 
+#include "magic_executor.h"
 #include "magic_export.h"
 #include "magic_type.h"
 
@@ -7,6 +8,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 namespace magic::gen1::slam {
 
@@ -183,6 +185,15 @@ class MAGIC_EXPORT_API SlamNavController final : public NonCopyable {
    */
   void SubscribeOdometry(const OdometryCallback callback);
 
+  /**
+   * @brief Subscribe to odometry data with dispatch options
+   * @param callback Processing callback after receiving odometry data
+   * @param options Dispatch policy, priority and CPU affinity of the thread running the callback
+   */
+  void SubscribeOdometry(OdometryCallback callback, const SubscriptionOptions& options) {
+    SubscribeOdometry(MakeDispatchedCallback(std::move(callback), options));
+  }
+
   /**
    * @brief Unsubscribe from odometry data
    */
@@ -0,0 +1,406 @@
+#pragma once
+
+#include "magic_motion.h"
+#include "magic_motion_command.h"
+#include "magic_motion_interpolator.h"
+#include "magic_realtime.h"
+#include "magic_type.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace magic::gen1::motion {
+
+class TrajectoryPlayer;
+using TrajectoryPlayerPtr = std::unique_ptr<TrajectoryPlayer>;
+
+/**
+ * @brief Time-indexed joint trajectory of one body part, stored as structure of arrays
+ *
+ * Every per-point field holds point_num * joint_num values, point-major: the value of joint j at point p is at
+ * index p * joint_num + j (see Index). Use Resize to size all arrays consistently.
+ */
+struct JointTrajectory {
+  BodyPartMask part = kBodyPartArm;     ///< Body part, one of arm, leg, head or waist
+  std::size_t joint_num = 0;            ///< Joints per point, must match the body part
+  std::size_t point_num = 0;            ///< Number of points
+  std::vector<int64_t> time_ns;         ///< Point times relative to the start, strictly increasing from 0 (unit: nanoseconds)
+  std::vector<int16_t> operation_mode;  ///< Operation mode per joint, constant over the trajectory
+  std::vector<double> pos;              ///< Target position per point and joint (unit: rad or m)
+  std::vector<double> vel;              ///< Target velocity per point and joint (unit: rad/s or m/s)
+  std::vector<double> toq;              ///< Target torque per point and joint (unit: Nm)
+  std::vector<double> kp;               ///< Position gain per point and joint
+  std::vector<double> kd;               ///< Velocity gain per point and joint
+
+  /**
+   * @brief Size all arrays for a body part and a number of points.
+   * @param body_part Body part, one of arm, leg, head or waist.
+   * @param points Number of points.
+   */
+  void Resize(BodyPartMask body_part, std::size_t points) {
+    part = body_part;
+    joint_num = detail::JointCount(body_part);
+    point_num = points;
+    time_ns.resize(points);
+    operation_mode.resize(joint_num, 200);
+    pos.resize(points * joint_num);
+    vel.resize(points * joint_num);
+    toq.resize(points * joint_num);
+    kp.resize(points * joint_num);
+    kd.resize(points * joint_num);
+  }
+
+  /**
+   * @brief Index of a value in the per-point arrays.
+   * @param point Point index.
+   * @param joint Joint index.
+   */
+  std::size_t Index(std::size_t point, std::size_t joint) const { return point * joint_num + joint; }
+
+  /**
+   * @brief Total duration.
+   * @return Time of the last point (unit: nanoseconds), 0 if empty.
+   */
+  int64_t Duration() const { return point_num > 0 ? time_ns[point_num - 1] : 0; }
+};
+
+/**
+ * @brief Trajectory playback state
+ */
+enum class TrajectoryState : int8_t {
+  IDLE = 0,      ///< No playback started since the trajectory was loaded
+  PLAYING = 1,   ///< Streaming commands
+  PAUSED = 2,    ///< Holding the current position, playback time is frozen
+  FINISHED = 3,  ///< Last point reached, no longer publishing
+  ABORTED = 4,   ///< Stopped by Abort, no longer publishing
+};
+
+/**
+ * @brief Trajectory playback progress
+ */
+struct TrajectoryProgress {
+  TrajectoryState state = TrajectoryState::IDLE;  ///< Playback state
+  std::size_t point = 0;                          ///< Index of the point at the start of the current segment
+  int64_t elapsed_ns = 0;                         ///< Playback time, excluding pauses (unit: nanoseconds)
+  int64_t duration_ns = 0;                        ///< Total trajectory duration (unit: nanoseconds)
+};
+
+/**
+ * @brief Trajectory player configuration
+ */
+struct TrajectoryPlayerOptions {
+  InterpolationMode mode = InterpolationMode::CUBIC_HERMITE;  ///< Interpolation between points that do not fall on a cycle
+  uint32_t progress_interval = 50;                            ///< Cycles between progress callbacks while playing, 0 reports state changes only
+  RtControlLoopOptions loop;                                  ///< Publish loop, its period is the output rate (default 500Hz)
+};
+
+/**
+ * @class TrajectoryPlayer
+ * @brief Streams a preloaded joint trajectory on a deadline-driven real-time thread.
+ *
+ * The trajectory is validated once by Load. Start, Pause, Resume and Abort only flip the playback state, the
+ * streaming itself happens on the player's RtControlLoop. While paused the player keeps publishing the last output
+ * with zero velocity; after the last point or an abort it stops publishing and its thread exits until the next Start.
+ * The progress callback runs on the player thread on every state change and every progress_interval cycles, it must
+ * not block. Commands are published through the command publisher, and the playback state is guarded by a
+ * priority-inheriting mutex so that the control interfaces cannot stall the player thread.
+ */
+class TrajectoryPlayer final : public NonCopyable {
+  using ProgressCallback = std::function<void(const TrajectoryProgress&)>;  // Progress and state change callback
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param publisher Command publisher used to publish the trajectory.
+   * @param options Player configuration.
+   */
+  explicit TrajectoryPlayer(LowLevelCommandPublisher& publisher, const TrajectoryPlayerOptions& options = {})
+      : publisher_(publisher), options_(options), loop_(options.loop) {
+    publish_.joints.reserve(std::max({kArmJointNum, kLegJointNum, kHeadJointNum, kWaistJointNum}));
+  }
+
+  /// Destructor, stops the player thread.
+  ~TrajectoryPlayer() { loop_.Stop(); }
+
+  /**
+   * @brief Validate and load a trajectory.
+   * @param trajectory Trajectory, taken over by the player.
+   * @return Execution status, fails while a trajectory is playing or paused, or if the trajectory is malformed.
+   */
+  Status Load(JointTrajectory trajectory) {
+    Status status = Validate(trajectory);
+    if (status.code != ErrorCode::OK) {
+      return status;
+    }
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    TrajectoryState state = state_.load();
+    if (state == TrajectoryState::PLAYING || state == TrajectoryState::PAUSED) {
+      return {ErrorCode::SERVICE_ERROR, "trajectory is playing"};
+    }
+    trajectory_ = std::move(trajectory);
+    output_.joints.assign(trajectory_.joint_num, SingleJointCommand{});
+    loaded_ = true;
+    state_.store(TrajectoryState::IDLE);
+    reported_state_ = TrajectoryState::IDLE;
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Start playback from the first point.
+   * @return Execution status, fails if no trajectory is loaded, it is already playing, or the thread cannot start.
+   */
+  Status Start() {
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+      if (!loaded_) {
+        return {ErrorCode::SERVICE_ERROR, "no trajectory loaded"};
+      }
+      TrajectoryState state = state_.load();
+      if (state == TrajectoryState::PLAYING || state == TrajectoryState::PAUSED) {
+        return {ErrorCode::SERVICE_ERROR, "trajectory is playing"};
+      }
+      restart_ = true;
+      state_.store(TrajectoryState::PLAYING);
+    }
+    if (!loop_.IsRunning()) {
+      Status status = loop_.Start([this](const RtCycleInfo& info) { Step(info.wakeup_ns); });
+      if (status.code != ErrorCode::OK) {
+        std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+        state_.store(TrajectoryState::IDLE);
+        return status;
+      }
+    }
+    return {ErrorCode::OK, ""};
+  }
+
+  /**
+   * @brief Pause playback, the current position is held.
+   * @return Execution status, fails if not playing.
+   */
+  Status Pause() { return Transition(TrajectoryState::PLAYING, TrajectoryState::PAUSED); }
+
+  /**
+   * @brief Resume a paused playback.
+   * @return Execution status, fails if not paused.
+   */
+  Status Resume() { return Transition(TrajectoryState::PAUSED, TrajectoryState::PLAYING); }
+
+  /**
+   * @brief Abort playback, publishing stops from the next cycle.
+   * @return Execution status, fails if neither playing nor paused.
+   */
+  Status Abort() {
+    Status status = Transition(TrajectoryState::PLAYING, TrajectoryState::ABORTED);
+    if (status.code != ErrorCode::OK) {
+      status = Transition(TrajectoryState::PAUSED, TrajectoryState::ABORTED);
+    }
+    return status;
+  }
+
+  /**
+   * @brief Set the progress callback.
+   * @param callback Called on the player thread on state changes and periodically while playing, nullptr to clear.
+   * @note May be called at any time, a callback already picked up by the current cycle still runs once.
+   */
+  void SetProgressCallback(ProgressCallback callback) {
+    auto shared = callback ? std::make_shared<const ProgressCallback>(std::move(callback)) : nullptr;
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    progress_callback_.swap(shared);
+  }
+
+  /**
+   * @brief Get the current playback progress.
+   */
+  TrajectoryProgress GetProgress() const {
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    return MakeProgress();
+  }
+
+  /**
+   * @brief Get the timing statistics of the player thread.
+   * @return Loop period, jitter and step time histograms.
+   */
+  RtControlLoopStats GetLoopStats() const { return loop_.GetStats(); }
+
+ private:
+  static Status Validate(const JointTrajectory& trajectory) {
+    std::size_t joint_num = detail::JointCount(trajectory.part);
+    std::size_t values = trajectory.point_num * joint_num;
+    if (joint_num == 0 || trajectory.joint_num != joint_num) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid body part or joint count"};
+    }
+    if (trajectory.point_num == 0 || trajectory.time_ns.size() != trajectory.point_num || trajectory.operation_mode.size() != joint_num) {
+      return {ErrorCode::INTERNAL_ERROR, "invalid point count"};
+    }
+    for (const std::vector<double>* field : {&trajectory.pos, &trajectory.vel, &trajectory.toq, &trajectory.kp, &trajectory.kd}) {
+      if (field->size() != values) {
+        return {ErrorCode::INTERNAL_ERROR, "invalid array size"};
+      }
+      for (double value : *field) {
+        if (!std::isfinite(value)) {
+          return {ErrorCode::INTERNAL_ERROR, "non-finite value"};
+        }
+      }
+    }
+    if (trajectory.time_ns[0] != 0) {
+      return {ErrorCode::INTERNAL_ERROR, "first point must be at time 0"};
+    }
+    for (std::size_t ii = 1; ii < trajectory.point_num; ii++) {
+      if (trajectory.time_ns[ii] <= trajectory.time_ns[ii - 1]) {
+        return {ErrorCode::INTERNAL_ERROR, "point times not increasing at point " + std::to_string(ii)};
+      }
+    }
+    return {ErrorCode::OK, ""};
+  }
+
+  Status Transition(TrajectoryState from, TrajectoryState to) {
+    std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+    if (state_.load() != from) {
+      return {ErrorCode::SERVICE_ERROR, "invalid trajectory state"};
+    }
+    state_.store(to);
+    return {ErrorCode::OK, ""};
+  }
+
+  TrajectoryProgress MakeProgress() const {
+    TrajectoryProgress progress;
+    progress.state = state_.load();
+    progress.point = point_;
+    progress.elapsed_ns = elapsed_ns_;
+    progress.duration_ns = trajectory_.Duration();
+    return progress;
+  }
+
+  // Load one point of the trajectory into a single joint command
+  void LoadPoint(std::size_t point, std::size_t joint, SingleJointCommand& command) const {
+    std::size_t index = trajectory_.Index(point, joint);
+    command.operation_mode = trajectory_.operation_mode[joint];
+    command.pos = trajectory_.pos[index];
+    command.vel = trajectory_.vel[index];
+    command.toq = trajectory_.toq[index];
+    command.kp = trajectory_.kp[index];
+    command.kd = trajectory_.kd[index];
+  }
+
+  // One cycle on the player thread
+  void Step(int64_t now) {
+    bool publish = false;
+    bool notify = false;
+    BodyPartMask part = kBodyPartNone;
+    TrajectoryProgress progress;
+    std::shared_ptr<const ProgressCallback> callback;
+    {
+      std::lock_guard<gen1::detail::PriorityInheritanceMutex> lock(mutex_);
+      TrajectoryState state = state_.load();
+      if (restart_) {
+        restart_ = false;
+        reported_state_ = TrajectoryState::IDLE;  // Reports the new playback even if it ends as the previous one did
+        elapsed_ns_ = 0;
+        point_ = 0;
+        cycles_ = 0;
+        has_output_ = false;
+      } else if (state == TrajectoryState::PLAYING && reported_state_ == TrajectoryState::PLAYING) {
+        elapsed_ns_ += now - last_step_ns_;
+      }
+      last_step_ns_ = now;
+
+      if (state == TrajectoryState::PLAYING) {
+        Advance();
+        state = state_.load();
+        publish = true;
+        has_output_ = true;
+      } else if (state == TrajectoryState::PAUSED && has_output_) {
+        for (auto& joint : output_.joints) {
+          joint.vel = 0.0;
+        }
+        publish = true;
+      }
+
+      bool changed = state != reported_state_;
+      reported_state_ = state;
+      notify = changed || (state == TrajectoryState::PLAYING && options_.progress_interval > 0 && cycles_ % options_.progress_interval == 0);
+      if (state == TrajectoryState::PLAYING) {
+        cycles_++;
+      }
+      progress = MakeProgress();
+      if (notify) {
+        callback = progress_callback_;  // A reference count increment, SetProgressCallback allocates outside the lock
+      }
+      if (state != TrajectoryState::PLAYING && state != TrajectoryState::PAUSED) {
+        // Nothing to publish until the next Start, which restarts the loop. Requested under the lock so that a Start
+        // after this cycle sees the loop stopping, and a Start before it keeps the loop running
+        loop_.RequestStop();
+      }
+      if (publish) {
+        // Load may replace the trajectory and the output as soon as the lock is released, e.g. after an Abort
+        part = trajectory_.part;
+        publish_.joints.assign(output_.joints.begin(), output_.joints.end());  // reuses the reserved capacity
+      }
+    }
+    if (publish) {
+      publish_.timestamp = now;
+      publisher_.PublishJointCommand(part, publish_);
+    }
+    if (callback) {
+      (*callback)(progress);
+    }
+  }
+
+  // Move to the segment containing the playback time and interpolate the output, finishes at the last point
+  void Advance() {
+    const std::size_t last = trajectory_.point_num - 1;
+    while (point_ < last && trajectory_.time_ns[point_ + 1] <= elapsed_ns_) {
+      point_++;
+    }
+    if (point_ == last) {
+      for (std::size_t jj = 0; jj < trajectory_.joint_num; jj++) {
+        LoadPoint(last, jj, output_.joints[jj]);
+      }
+      elapsed_ns_ = trajectory_.Duration();
+      state_.store(TrajectoryState::FINISHED);
+      return;
+    }
+    int64_t begin = trajectory_.time_ns[point_];
+    int64_t end = trajectory_.time_ns[point_ + 1];
+    double duration_s = static_cast<double>(end - begin) * 1e-9;
+    double s = static_cast<double>(elapsed_ns_ - begin) / static_cast<double>(end - begin);
+    SingleJointCommand from;
+    SingleJointCommand to;
+    for (std::size_t jj = 0; jj < trajectory_.joint_num; jj++) {
+      LoadPoint(point_, jj, from);
+      LoadPoint(point_ + 1, jj, to);
+      detail::InterpolateJoint(options_.mode, from, to, duration_s, s, output_.joints[jj]);
+    }
+  }
+
+  LowLevelCommandPublisher& publisher_;
+  const TrajectoryPlayerOptions options_;
+
+  mutable gen1::detail::PriorityInheritanceMutex mutex_;  // Guards the playback state against the player thread
+  std::atomic<TrajectoryState> state_{TrajectoryState::IDLE};
+  TrajectoryState reported_state_ = TrajectoryState::IDLE;  // Last state seen by the player thread
+  std::shared_ptr<const ProgressCallback> progress_callback_;
+  JointTrajectory trajectory_;
+  bool loaded_ = false;
+  bool restart_ = false;
+  bool has_output_ = false;  // Output holds an interpolated command of the current playback
+  std::size_t point_ = 0;
+  int64_t elapsed_ns_ = 0;
+  int64_t last_step_ns_ = 0;
+  uint64_t cycles_ = 0;
+  JointCommand output_{0, {}};
+  JointCommand publish_{0, {}};  // Copy of the output published by the player thread, touched only by that thread
+
+  RtControlLoop loop_;
+};
+
+}  // namespace magic::gen1::motion
\ No newline at end of file
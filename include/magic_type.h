@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -211,7 +212,7 @@ enum class TrickAction : int32_t {
  */
 struct SingleHandJointCommand {
   int16_t operation_mode = 0;  ///< Control mode (such as position, torque, impedance, etc.)
-  std::vector<double> pos;     ///< Desired position array (7 degrees of freedom)
+  std::vector<double> pos;     ///< Desired position array (6 degrees of freedom)
 };
 
 /**
@@ -241,6 +242,53 @@ struct HandState {
   std::vector<SingleHandJointState> state;  ///< All hand joint states (total of two), left hand and right hand in sequence
 };
 
+/**
+ * @brief Hand index in the fixed-size hand command and state
+ */
+enum HandSide : std::size_t {
+  kLeftHand = 0,   ///< Left hand
+  kRightHand = 1,  ///< Right hand
+};
+
+/**
+ * @brief Fixed-size single hand joint control command
+ */
+struct FixedSingleHandJointCommand {
+  int16_t operation_mode = 0;               ///< Control mode (such as position, torque, impedance, etc.)
+  std::array<double, kHandJointNum> pos{};  ///< Desired position of every degree of freedom
+};
+
+/**
+ * @brief Fixed-size hand control command
+ *
+ * Same content as HandCommand for both hands, stored inline so it can be filled and published without allocating.
+ */
+struct FixedHandCommand {
+  int64_t timestamp = 0;                                      ///< Timestamp (unit: nanoseconds)
+  std::array<FixedSingleHandJointCommand, kHandNum> hands{};  ///< Left hand and right hand, indexed by HandSide
+};
+
+/**
+ * @brief Fixed-size single hand joint state
+ */
+struct FixedSingleHandJointState {
+  int16_t status_word = 0;                  ///< Status
+  int16_t error_code = 0;                   ///< Error code (0 means normal)
+  std::array<double, kHandJointNum> pos{};  ///< Actual position (unit depends on controller definition)
+  std::array<double, kHandJointNum> toq{};  ///< Actual torque (unit: Nm)
+  std::array<double, kHandJointNum> cur{};  ///< Actual current (unit: A)
+};
+
+/**
+ * @brief Fixed-size hand state
+ *
+ * Same content as HandState for both hands, stored inline so it can be copied without allocating.
+ */
+struct FixedHandState {
+  int64_t timestamp = 0;                                    ///< Timestamp (unit: nanoseconds)
+  std::array<FixedSingleHandJointState, kHandNum> hands{};  ///< Left hand and right hand, indexed by HandSide
+};
+
 /**
  * @brief Single joint control command
  */
@@ -259,13 +307,156 @@ struct SingleJointCommand {
  * Lower limbs contain 12 joint state items, in the same order as control commands.
  * Upper limbs contain 14 joint state items, in the same order as control commands.
  * Head contains 2 joint state items, in the same order as control commands.
- * Waist contains 3 joint state items, in the same order as control commands.
+ * Waist contains 2 joint state items, in the same order as control commands.
  */
 struct JointCommand {
   int64_t timestamp;                       ///< Timestamp (unit: nanoseconds)
   std::vector<SingleJointCommand> joints;  ///< Control commands for all joints
 };
 
+/**
+ * @brief Body part selection mask for whole-body commands
+ */
+enum BodyPartMask : uint8_t {
+  kBodyPartNone = 0,
+  kBodyPartArm = 1 << 0,    ///< Upper limbs
+  kBodyPartLeg = 1 << 1,    ///< Lower limbs
+  kBodyPartHead = 1 << 2,   ///< Head
+  kBodyPartWaist = 1 << 3,  ///< Waist
+  kBodyPartHand = 1 << 4,   ///< Both hands
+  kBodyPartAll = kBodyPartArm | kBodyPartLeg | kBodyPartHead | kBodyPartWaist | kBodyPartHand,
+};
+
+/**
+ * @brief Upper limbs descriptor, left arm joints 1-7 followed by right arm joints 1-7
+ */
+struct ArmLimb {
+  static constexpr BodyPartMask kPart = kBodyPartArm;     ///< Body part
+  static constexpr std::size_t kJointNum = kArmJointNum;  ///< Number of joints
+  static constexpr std::size_t kJointsPerSide = 7;        ///< Joints per arm
+
+  /// Joint indices, numbered as in the joint control documentation
+  enum Joint : std::size_t {
+    kLeftJoint1 = 0,
+    kLeftJoint2,
+    kLeftJoint3,
+    kLeftJoint4,
+    kLeftJoint5,
+    kLeftJoint6,
+    kLeftJoint7,
+    kRightJoint1,
+    kRightJoint2,
+    kRightJoint3,
+    kRightJoint4,
+    kRightJoint5,
+    kRightJoint6,
+    kRightJoint7,
+  };
+};
+
+/**
+ * @brief Lower limbs descriptor, left leg joints 1-6 followed by right leg joints 1-6
+ */
+struct LegLimb {
+  static constexpr BodyPartMask kPart = kBodyPartLeg;     ///< Body part
+  static constexpr std::size_t kJointNum = kLegJointNum;  ///< Number of joints
+  static constexpr std::size_t kJointsPerSide = 6;        ///< Joints per leg
+
+  /// Joint indices, numbered as in the joint control documentation
+  enum Joint : std::size_t {
+    kLeftJoint1 = 0,
+    kLeftJoint2,
+    kLeftJoint3,
+    kLeftJoint4,
+    kLeftJoint5,
+    kLeftJoint6,
+    kRightJoint1,
+    kRightJoint2,
+    kRightJoint3,
+    kRightJoint4,
+    kRightJoint5,
+    kRightJoint6,
+  };
+};
+
+/**
+ * @brief Head descriptor
+ */
+struct HeadLimb {
+  static constexpr BodyPartMask kPart = kBodyPartHead;     ///< Body part
+  static constexpr std::size_t kJointNum = kHeadJointNum;  ///< Number of joints
+
+  /// Joint indices, numbered as in the joint control documentation
+  enum Joint : std::size_t {
+    kJoint1 = 0,
+    kJoint2,
+  };
+};
+
+/**
+ * @brief Waist descriptor
+ */
+struct WaistLimb {
+  static constexpr BodyPartMask kPart = kBodyPartWaist;     ///< Body part
+  static constexpr std::size_t kJointNum = kWaistJointNum;  ///< Number of joints
+
+  /// Joint indices, numbered as in the joint control documentation
+  enum Joint : std::size_t {
+    kJoint1 = 0,
+    kJoint2,
+  };
+};
+
+static_assert(ArmLimb::kRightJoint7 + 1 == ArmLimb::kJointNum && ArmLimb::kJointsPerSide * 2 == ArmLimb::kJointNum);
+static_assert(LegLimb::kRightJoint6 + 1 == LegLimb::kJointNum && LegLimb::kJointsPerSide * 2 == LegLimb::kJointNum);
+static_assert(HeadLimb::kJoint2 + 1 == HeadLimb::kJointNum);
+static_assert(WaistLimb::kJoint2 + 1 == WaistLimb::kJointNum);
+
+/**
+ * @brief Fixed-size joint control command of one body part
+ *
+ * Same content as JointCommand, but the joint array is stored inline with the size of the limb descriptor, so
+ * filling and publishing a command never touches the heap and never needs a runtime size check. Commands of
+ * different body parts are distinct types, passing one to the publish interface of another does not compile.
+ * Prefer the per-component aliases below.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct JointCommandT {
+  using LimbType = Limb;                                     ///< Limb descriptor
+  static constexpr std::size_t kJointNum = Limb::kJointNum;  ///< Number of joints
+
+  int64_t timestamp = 0;                               ///< Timestamp (unit: nanoseconds)
+  std::array<SingleJointCommand, kJointNum> joints{};  ///< Control commands for all joints
+
+  /// Access a joint by its named index
+  SingleJointCommand& operator[](typename Limb::Joint joint) { return joints[joint]; }
+  /// Access a joint by its named index
+  const SingleJointCommand& operator[](typename Limb::Joint joint) const { return joints[joint]; }
+};
+
+using ArmJointCommand = JointCommandT<ArmLimb>;      ///< Upper limbs control command (14 joints)
+using LegJointCommand = JointCommandT<LegLimb>;      ///< Lower limbs control command (12 joints)
+using HeadJointCommand = JointCommandT<HeadLimb>;    ///< Head control command (2 joints)
+using WaistJointCommand = JointCommandT<WaistLimb>;  ///< Waist control command (2 joints)
+
+/**
+ * @brief Whole-body control command
+ *
+ * Bundles the commands of all body parts for one control cycle. The shared timestamp overrides the timestamps of the
+ * individual part commands, so every part is stamped with the same control cycle.
+ */
+struct WholeBodyCommand {
+  int64_t timestamp = 0;         ///< Timestamp shared by all parts (unit: nanoseconds)
+  uint8_t parts = kBodyPartAll;  ///< Parts to publish, combination of BodyPartMask
+  ArmJointCommand arm;           ///< Upper limbs control command
+  LegJointCommand leg;           ///< Lower limbs control command
+  HeadJointCommand head;         ///< Head control command
+  WaistJointCommand waist;       ///< Waist control command
+  FixedHandCommand hand;         ///< Hand control command
+};
+
 /**
  * @brief Single joint state information
  */
@@ -285,13 +476,69 @@ struct SingleJointState {
  * Lower limbs contain 12 joint state items, in the same order as control commands.
  * Upper limbs contain 14 joint state items, in the same order as control commands.
  * Head contains 2 joint state items, in the same order as control commands.
- * Waist contains 3 joint state items, in the same order as control commands.
+ * Waist contains 2 joint state items, in the same order as control commands.
  */
 struct JointState {
   int64_t timestamp;                     ///< Timestamp (unit: nanoseconds)
   std::vector<SingleJointState> joints;  ///< State data for all joints
 };
 
+/**
+ * @brief Fixed-size joint state of one body part
+ *
+ * Same content as JointState, with the joint array stored inline with the size of the limb descriptor.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct JointStateT {
+  using LimbType = Limb;                                     ///< Limb descriptor
+  static constexpr std::size_t kJointNum = Limb::kJointNum;  ///< Number of joints
+
+  int64_t timestamp = 0;                             ///< Timestamp (unit: nanoseconds)
+  std::array<SingleJointState, kJointNum> joints{};  ///< State data for all joints
+
+  /// Access a joint by its named index
+  SingleJointState& operator[](typename Limb::Joint joint) { return joints[joint]; }
+  /// Access a joint by its named index
+  const SingleJointState& operator[](typename Limb::Joint joint) const { return joints[joint]; }
+};
+
+using ArmJointState = JointStateT<ArmLimb>;      ///< Upper limbs joint state (14 joints)
+using LegJointState = JointStateT<LegLimb>;      ///< Lower limbs joint state (12 joints)
+using HeadJointState = JointStateT<HeadLimb>;    ///< Head joint state (2 joints)
+using WaistJointState = JointStateT<WaistLimb>;  ///< Waist joint state (2 joints)
+
+/**
+ * @brief Structure-of-arrays joint state of one body part
+ *
+ * Same content as JointStateT, with one contiguous array per field instead of one record per joint, so loops over a
+ * single field (e.g. all positions) load consecutive doubles. Every array starts on a 64-byte boundary, which covers
+ * AVX-512, AVX and NEON vector loads.
+ *
+ * @tparam Limb Limb descriptor (ArmLimb, LegLimb, HeadLimb or WaistLimb).
+ */
+template <typename Limb>
+struct JointStateSoA {
+  using LimbType = Limb;                                     ///< Limb descriptor
+  static constexpr std::size_t kJointNum = Limb::kJointNum;  ///< Number of joints
+  using Array = std::array<double, kJointNum>;               ///< One value per joint
+
+  int64_t timestamp = 0;                                     ///< Timestamp (unit: nanoseconds)
+  alignas(64) Array posH{};                                  ///< Actual positions (high encoder reading)
+  alignas(64) Array posL{};                                  ///< Actual positions (low encoder reading)
+  alignas(64) Array vel{};                                   ///< Current velocities (unit: rad/s or m/s)
+  alignas(64) Array toq{};                                   ///< Current torques (unit: Nm)
+  alignas(64) Array current{};                               ///< Current currents (unit: A)
+  alignas(64) std::array<int16_t, kJointNum> status_word{};  ///< Current joint states (custom state machine encoding)
+  std::array<int16_t, kJointNum> err_code{};                 ///< Error codes
+};
+
+using ArmJointStateSoA = JointStateSoA<ArmLimb>;      ///< Upper limbs structure-of-arrays joint state (14 joints)
+using LegJointStateSoA = JointStateSoA<LegLimb>;      ///< Lower limbs structure-of-arrays joint state (12 joints)
+using HeadJointStateSoA = JointStateSoA<HeadLimb>;    ///< Head structure-of-arrays joint state (2 joints)
+using WaistJointStateSoA = JointStateSoA<WaistLimb>;  ///< Waist structure-of-arrays joint state (2 joints)
+
 /************************************************************
  *                        Voice Control                     *
  ************************************************************/